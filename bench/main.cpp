@@ -0,0 +1,434 @@
+// Synthetic benchmarks of ImGui-SFML's hot paths: ProcessEvent, Update and
+// the GL submission of draw data. Results are printed as JSON.
+//
+// Usage: imgui-sfml-bench [--quick] [--output results.json]
+// Built with IMGUI_SFML_THREAD_LOCAL_CONTEXT, it also times contexts building
+// frames on several threads at once.
+// Without a display (e.g. CI): xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 imgui-sfml-bench
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/OpenGL.hpp>
+#include <SFML/Window/Event.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+struct Result {
+    std::string name;
+    std::string params;    // JSON object with the workload parameters
+    long long iterations;  // events or frames
+    std::vector<double> samplesNs;  // per iteration
+};
+
+std::vector<Result> results;
+
+void addResult(const std::string& name, const std::string& params, long long iterations,
+               std::vector<double>& samplesNs) {
+    Result result;
+    result.name = name;
+    result.params = params;
+    result.iterations = iterations;
+    result.samplesNs.swap(samplesNs);
+    std::sort(result.samplesNs.begin(), result.samplesNs.end());
+    results.push_back(result);
+    std::fprintf(stderr, "%-40s %s done\n", name.c_str(), params.c_str());
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+void writeJson(std::FILE* out, const char* glRenderer, const char* glVersion) {
+    std::fprintf(out, "{\n  \"imgui_version\": \"%s\",\n", IMGUI_VERSION);
+    std::fprintf(out, "  \"gl_renderer\": \"%s\",\n  \"gl_version\": \"%s\",\n",
+                 glRenderer, glVersion);
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double total = 0.0;
+        for (size_t s = 0; s < r.samplesNs.size(); ++s) total += r.samplesNs[s];
+        double mean = r.samplesNs.empty() ? 0.0 : total / r.samplesNs.size();
+        std::fprintf(out,
+                     "    {\"name\": \"%s\", \"params\": %s, \"iterations\": %lld, "
+                     "\"mean_ns\": %.1f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+                     "\"min_ns\": %.1f, \"max_ns\": %.1f, \"throughput_per_s\": %.1f}%s\n",
+                     r.name.c_str(), r.params.c_str(), r.iterations, mean,
+                     percentile(r.samplesNs, 0.5), percentile(r.samplesNs, 0.99),
+                     r.samplesNs.empty() ? 0.0 : r.samplesNs.front(),
+                     r.samplesNs.empty() ? 0.0 : r.samplesNs.back(),
+                     total > 0.0 ? r.iterations * 1e9 / total : 0.0,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+// Events which don't accumulate in ImGui's input queue, so that floods of
+// any size can be processed without starting frames
+sf::Event makeEvent(int i) {
+    sf::Event event;
+    switch (i % 4) {
+        case 0:
+            event.type = sf::Event::MouseMoved;
+            event.mouseMove.x = i % 1280;
+            event.mouseMove.y = i % 720;
+            break;
+        case 1:
+            event.type = (i / 4) % 2 ? sf::Event::MouseButtonReleased
+                                     : sf::Event::MouseButtonPressed;
+            event.mouseButton.button = sf::Mouse::Left;
+            event.mouseButton.x = i % 1280;
+            event.mouseButton.y = i % 720;
+            break;
+        case 2:
+            event.type = (i / 4) % 2 ? sf::Event::KeyReleased : sf::Event::KeyPressed;
+            event.key.code = static_cast<sf::Keyboard::Key>(i % sf::Keyboard::KeyCount);
+            event.key.alt = event.key.control = event.key.shift = event.key.system = false;
+            break;
+        default:
+            event.type = sf::Event::MouseWheelScrolled;
+            event.mouseWheelScroll.wheel = sf::Mouse::VerticalWheel;
+            event.mouseWheelScroll.delta = 0.f;
+            event.mouseWheelScroll.x = event.mouseWheelScroll.y = 0;
+            break;
+    }
+    return event;
+}
+
+void benchProcessEvent(ImGui::SFML::ImGuiSFMLContext& context, long long eventCount) {
+    const int BATCH = 1000;
+    std::vector<sf::Event> events(BATCH);
+    for (int i = 0; i < BATCH; ++i) events[i] = makeEvent(i);
+
+    context.windowHasFocus = true;
+    std::vector<double> samples;
+    for (long long done = 0; done < eventCount; done += BATCH) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < BATCH; ++i) {
+            ImGui::SFML::ProcessEvent(context, events[i]);
+        }
+        samples.push_back(elapsedNs(start) / BATCH);
+    }
+
+    char params[64];
+    std::snprintf(params, sizeof(params), "{\"batch\": %d}", BATCH);
+    addResult("process_event/flood", params, eventCount, samples);
+}
+
+void benchUpdate(ImGui::SFML::ImGuiSFMLContext& context, sf::RenderWindow& window,
+                 int frames, bool gamepadNav, bool pollInput) {
+    ImGuiIO& io = ImGui::GetIO();  // Init and Update make the context current
+    context.pollInputDevices = pollInput;
+    if (gamepadNav) {
+        io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+        // read even if no joystick is plugged in
+        ImGui::SFML::SetActiveJoystickId(context, 0);
+    } else {
+        io.ConfigFlags &= ~ImGuiConfigFlags_NavEnableGamepad;
+    }
+
+    std::vector<double> samples;
+    unsigned int queries = 0;
+    for (int f = 0; f < frames; ++f) {
+        ImGui::SFML::ProcessEvent(context, makeEvent(f * 4));  // mouse move
+        Clock::time_point start = Clock::now();
+        ImGui::SFML::Update(context, window, sf::milliseconds(16));
+        samples.push_back(elapsedNs(start));
+        queries = context.inputStats.frameQueries;
+        ImGui::EndFrame();
+    }
+
+    char params[128];
+    std::snprintf(params, sizeof(params),
+                  "{\"gamepad_nav\": %s, \"poll_input\": %s, \"input_queries\": %u}",
+                  gamepadNav ? "true" : "false", pollInput ? "true" : "false", queries);
+    addResult("update", params, frames, samples);
+    io.ConfigFlags &= ~ImGuiConfigFlags_NavEnableGamepad;
+    context.pollInputDevices = false;
+}
+
+// Draw lists made of quads spread over the screen, split so that 16-bit
+// indices are enough for each list
+struct SyntheticDrawData {
+    std::vector<ImDrawList*> lists;
+    ImDrawData data;
+
+    ~SyntheticDrawData() {
+        for (size_t i = 0; i < lists.size(); ++i) IM_DELETE(lists[i]);
+    }
+};
+
+void buildDrawData(SyntheticDrawData& out, int vertexCount, int commandCount,
+                   const std::vector<ImTextureID>& textures, const ImVec2& displaySize) {
+    const int VERTICES_PER_LIST = 60000;
+    int quads = std::max(1, vertexCount / 4);
+    int quadsPerCommand = std::max(1, quads / commandCount);
+
+    ImDrawList* list = NULL;
+    for (int q = 0; q < quads; ++q) {
+        if (!list || list->VtxBuffer.Size + 4 > VERTICES_PER_LIST) {
+            list = IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData());
+            list->Clear();
+            out.lists.push_back(list);
+        }
+
+        if (q % quadsPerCommand == 0 || list->CmdBuffer.Size == 0) {
+            // a new clip rect and texture for each command
+            int command = q / quadsPerCommand;
+            if (list->CmdBuffer.Size > 0) {
+                list->PopTextureID();
+                list->PopClipRect();
+            }
+            float x = static_cast<float>((command * 37) % static_cast<int>(displaySize.x / 2));
+            float y = static_cast<float>((command * 53) % static_cast<int>(displaySize.y / 2));
+            list->PushClipRect(ImVec2(x, y), ImVec2(x + displaySize.x / 2, y + displaySize.y / 2));
+            list->PushTextureID(textures[command % textures.size()]);
+        }
+
+        float x = static_cast<float>((q * 7) % static_cast<int>(displaySize.x - 16));
+        float y = static_cast<float>((q * 13) % static_cast<int>(displaySize.y - 16));
+        list->PrimReserve(6, 4);
+        list->PrimRectUV(ImVec2(x, y), ImVec2(x + 16, y + 16), ImVec2(0, 0), ImVec2(1, 1),
+                         IM_COL32(255, 255, 255, 128));
+    }
+
+    ImDrawData& data = out.data;
+    data.Valid = true;
+    data.CmdLists = out.lists.data();
+    data.CmdListsCount = static_cast<int>(out.lists.size());
+    data.TotalVtxCount = data.TotalIdxCount = 0;
+    for (size_t i = 0; i < out.lists.size(); ++i) {
+        data.TotalVtxCount += out.lists[i]->VtxBuffer.Size;
+        data.TotalIdxCount += out.lists[i]->IdxBuffer.Size;
+    }
+    data.DisplayPos = ImVec2(0, 0);
+    data.DisplaySize = displaySize;
+#if IMGUI_VERSION_NUM >= 16900
+    data.FramebufferScale = ImVec2(1, 1);
+#endif
+}
+
+void benchRender(ImGui::SFML::ImGuiSFMLContext& context, sf::RenderWindow& window,
+                 const char* path, int vertexCount, int commandCount,
+                 const std::vector<ImTextureID>& textures, int frames) {
+    ImGuiIO& io = ImGui::GetIO();  // Init and Update make the context current
+    SyntheticDrawData drawData;
+    buildDrawData(drawData, vertexCount, commandCount, textures, io.DisplaySize);
+
+    // submission only, and submission until the GPU is done
+    std::vector<double> submitSamples, finishSamples;
+    // and GPU time from timer queries, read back by the following renders
+    std::vector<double> gpuSamples;
+    unsigned int lastGpuRender = 0;
+    for (int f = 0; f < frames; ++f) {
+        window.clear();
+        glFinish();
+        Clock::time_point start = Clock::now();
+        ImGui::SFML::RenderDrawData(context, window, &drawData.data);
+        submitSamples.push_back(elapsedNs(start));
+        glFinish();
+        finishSamples.push_back(elapsedNs(start));
+
+        ImGui::SFML::ImGuiSFMLContext::GPUTimings timings;
+        if (ImGui::SFML::GetGPUTimings(context, timings) && timings.render != lastGpuRender) {
+            lastGpuRender = timings.render;
+            gpuSamples.push_back(timings.totalMs * 1e6);
+        }
+    }
+
+    char params[256];
+    std::snprintf(params, sizeof(params),
+                  "{\"path\": \"%s\", \"vertices\": %d, \"commands\": %d, \"textures\": %d, "
+                  "\"draw_calls\": %u}",
+                  path, drawData.data.TotalVtxCount, commandCount,
+                  static_cast<int>(textures.size()), context.renderStats.drawCalls);
+    addResult("render/submit", params, frames, submitSamples);
+    addResult("render/finish", params, frames, finishSamples);
+    if (!gpuSamples.empty()) {
+        addResult("render/gpu", params, static_cast<long long>(gpuSamples.size()), gpuSamples);
+    }
+}
+
+#ifdef IMGUI_SFML_THREAD_LOCAL_CONTEXT
+// A window of a few hundred widgets, built (without rendering) on the calling thread
+void buildStressFrames(ImGui::SFML::ImGuiSFMLContext* context, int frames) {
+    float value = 0.5f;
+    for (int f = 0; f < frames; ++f) {
+        ImGui::SFML::Update(*context, sf::Vector2i(f % 1280, f % 720), sf::Vector2f(1280, 720),
+                            sf::milliseconds(16));
+        ImGui::Begin("stress");
+        for (int i = 0; i < 300; ++i) {
+            ImGui::PushID(i);
+            ImGui::Text("item %d", i);
+            ImGui::SameLine();
+            ImGui::Button("button");
+            ImGui::SliderFloat("value", &value, 0.f, 1.f);
+            ImGui::PopID();
+        }
+        ImGui::End();
+        ImGui::Render();
+    }
+}
+
+// Aggregate frames per second of N contexts, each on its own thread. With
+// perfect scaling, throughput grows linearly up to the number of cores.
+// Each context has its own font atlas: NewFrame and EndFrame write to the
+// atlas, so a SharedFontAtlas can't be used by contexts on several threads.
+void benchParallelContexts(sf::RenderWindow& window, int threadCount, int frames) {
+    std::vector<std::unique_ptr<ImGui::SFML::ImGuiSFMLContext> > contexts;
+    for (int i = 0; i < threadCount; ++i) {
+        contexts.push_back(std::unique_ptr<ImGui::SFML::ImGuiSFMLContext>(
+            new ImGui::SFML::ImGuiSFMLContext()));
+        ImGui::SFML::Init(*contexts.back(), window);
+        ImGui::GetIO().IniFilename = NULL;  // Init makes the context current
+    }
+
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.push_back(std::thread(buildStressFrames, contexts[i].get(), frames));
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        threads[i].join();
+    }
+    double wallNs = elapsedNs(start);
+
+    for (int i = 0; i < threadCount; ++i) {
+        ImGui::SFML::Shutdown(*contexts[i]);
+    }
+
+    // one sample per round of frames, so that throughput counts the frames of all threads
+    std::vector<double> samples(frames, wallNs / frames);
+    char params[64];
+    std::snprintf(params, sizeof(params), "{\"threads\": %d}", threadCount);
+    addResult("update/parallel_contexts", params, (long long)threadCount * frames, samples);
+}
+#endif
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    const char* outputPath = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--quick] [--output results.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    int scale = quick ? 10 : 1;
+
+    sf::RenderWindow window(sf::VideoMode(1280, 720), "imgui-sfml-bench");
+    window.setVerticalSyncEnabled(false);
+    window.setActive(true);
+
+    ImGui::SFML::ImGuiSFMLContext context;
+    ImGui::SFML::Init(context, window);
+
+    std::vector<sf::Texture> textureStorage(16);
+    std::vector<ImTextureID> textures;
+    for (size_t i = 0; i < textureStorage.size(); ++i) {
+        textureStorage[i].create(64, 64);
+        textures.push_back((ImTextureID)(size_t)textureStorage[i].getNativeHandle());
+    }
+
+    benchProcessEvent(context, 1000000 / scale);
+    for (int poll = 0; poll < 2; ++poll) {
+        benchUpdate(context, window, 2000 / scale, false, poll != 0);
+        benchUpdate(context, window, 2000 / scale, true, poll != 0);
+    }
+
+#ifdef IMGUI_SFML_THREAD_LOCAL_CONTEXT
+    {
+        int cores = std::max(1, (int)std::thread::hardware_concurrency());
+        for (int threadCount = 1;; threadCount *= 2) {
+            benchParallelContexts(window, std::min(threadCount, cores), 500 / scale);
+            if (threadCount >= cores) break;
+        }
+    }
+#endif
+
+    // Update once so that io.DisplaySize is set (and the first context is current again)
+    ImGui::SFML::Update(context, window, sf::milliseconds(16));
+    ImGui::EndFrame();
+
+    struct Workload {
+        int vertices, commands, textures, frames;
+    };
+    const Workload workloads[] = {
+        {1000, 1, 1, 500},
+        {1000, 100, 16, 500},
+        {100000, 1000, 16, 100},
+        {1000000, 10000, 16, 20},
+    };
+
+    struct Path {
+        const char* name;
+        ImGui::SFML::RendererType renderer;
+        bool useVertexBuffers;
+    };
+    const Path paths[] = {
+        {"fixed_function", ImGui::SFML::Renderer_FixedFunction, false},
+        {"fixed_function_vbo", ImGui::SFML::Renderer_FixedFunction, true},
+        {"shader", ImGui::SFML::Renderer_Shader, true},
+    };
+
+    for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); ++p) {
+        ImGui::SFML::ImGuiSFMLContext pathContext;
+        pathContext.renderer = paths[p].renderer;
+        pathContext.useVertexBuffers = paths[p].useVertexBuffers;
+        pathContext.gpuTiming = true;
+        ImGui::SFML::Init(pathContext, window);
+        if (pathContext.renderer != paths[p].renderer) {
+            std::fprintf(stderr, "%s renderer unavailable, skipped\n", paths[p].name);
+            ImGui::SFML::Shutdown(pathContext);
+            continue;
+        }
+        ImGui::SFML::Update(pathContext, window, sf::milliseconds(16));
+        ImGui::EndFrame();
+
+        for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); ++w) {
+            const Workload& workload = workloads[w];
+            std::vector<ImTextureID> used(textures.begin(), textures.begin() + workload.textures);
+            benchRender(pathContext, window, paths[p].name, workload.vertices,
+                        workload.commands, used, std::max(2, workload.frames / scale));
+        }
+        ImGui::SFML::Shutdown(pathContext);
+    }
+
+    const char* glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    std::FILE* out = outputPath ? std::fopen(outputPath, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "can't open %s\n", outputPath);
+        return 1;
+    }
+    writeJson(out, glRenderer ? glRenderer : "", glVersion ? glVersion : "");
+    if (outputPath) std::fclose(out);
+
+    ImGui::SFML::Shutdown(context);
+    return 0;
+}
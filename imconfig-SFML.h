@@ -29,4 +29,20 @@
             static_cast<sf::Uint8>(w * 255.f));                         \
     }
 
-#define ImTextureID unsigned int
+// ImGui's current context (GImGui) is global: two threads can't build frames at
+// the same time. With IMGUI_SFML_THREAD_LOCAL_CONTEXT (the CMake option of the
+// same name), it's per thread, so each window can run its update and render loop
+// on its own thread. The ImGui sources must be compiled with this config too.
+#ifdef IMGUI_SFML_THREAD_LOCAL_CONTEXT
+struct ImGuiContext;
+extern thread_local ImGuiContext* ImGuiSFMLCurrentContext;
+#define GImGui ImGuiSFMLCurrentContext
+#endif
+
+// ImTextureID is ImGui's default (void*): ImGui-SFML puts either a GL texture
+// name or the ID of a registered sf::Texture in it (see ImGui::SFML::GetTextureID)
+
+// ImGui-SFML draws with 32-bit indices if you uncomment this. With ImGui >= 1.71,
+// 16-bit indices are enough for draw lists above 64k vertices (they're split
+// with ImDrawCmd::VtxOffset), so only do this for older versions of ImGui.
+//#define ImDrawIdx unsigned int
@@ -2,21 +2,59 @@
 
 #include <SFML/Config.hpp>
 #include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/OpenGL.hpp>
+#include <SFML/System/Err.hpp>
+#include <SFML/System/Sleep.hpp>
+#include <SFML/System/Utf.hpp>
 #include <SFML/Window/Clipboard.hpp>
+#include <SFML/Window/Context.hpp>
 #include <SFML/Window/Cursor.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/Touch.hpp>
 #include <SFML/Window/Window.hpp>
 
+#include <algorithm>  // min
+#include <atomic>
 #include <cassert>
+#include <climits>  // INT_MAX
+#include <chrono>
+#include <condition_variable>
+#include <cfloat>   // FLT_MAX
 #include <cmath>    // abs
 #include <cstddef>  // offsetof, NULL
+#include <cstdio>   // font atlas cache file
+#include <cstdlib>  // atoi
 #include <cstring>  // memcpy
+#include <iterator> // back_inserter
+#include <mutex>    // call_once
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_SFML_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #ifdef ANDROID
 #ifdef USE_JNI
@@ -109,26 +147,655 @@ int closeKeyboardIME() {
 #endif
 #include <imgui_internal.h>
 
+#ifdef IMGUI_SFML_THREAD_LOCAL_CONTEXT
+// ImGui's current context, see imconfig-SFML.h
+thread_local ImGuiContext* ImGuiSFMLCurrentContext = NULL;
+#endif
+
+// stb_truetype rasterizes the glyphs of dynamic fonts. imgui_draw.cpp compiles
+// it as static functions, so this file needs its own copy.
+#ifndef STB_TRUETYPE_IMPLEMENTATION
+#ifndef IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_malloc(x, u) ((void)(u), IM_ALLOC(x))
+#define STBTT_free(x, u) ((void)(u), IM_FREE(x))
+#define STBTT_assert(x) IM_ASSERT(x)
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#else
+#define STBTT_DEF extern
+#endif
+#if defined(__clang__) || defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4505)  // unreferenced local function
+#endif
+#ifdef IMGUI_STB_TRUETYPE_FILENAME
+#include IMGUI_STB_TRUETYPE_FILENAME
+#else
+#include "imstb_truetype.h"
+#endif
+#if defined(__clang__) || defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+#endif
+
 #if __cplusplus >= 201103L  // C++11 and above
 static_assert(sizeof(GLuint) <= sizeof(ImTextureID),
               "ImTextureID is not large enough to fit GLuint.");
 #endif
 
+// OpenGL enums which might be missing from the OpenGL 1.1 headers that
+// SFML/OpenGL.hpp includes on some platforms
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_ELEMENT_ARRAY_BUFFER
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_RANGE_BIT
+#define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#endif
+#ifndef GL_MAP_UNSYNCHRONIZED_BIT
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#endif
+#ifndef GL_ARRAY_BUFFER_BINDING
+#define GL_ARRAY_BUFFER_BINDING 0x8894
+#endif
+#ifndef GL_VERTEX_ARRAY_BINDING
+#define GL_VERTEX_ARRAY_BINDING 0x85B5
+#endif
+#ifndef GL_CURRENT_PROGRAM
+#define GL_CURRENT_PROGRAM 0x8B8D
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+#ifndef GL_INFO_LOG_LENGTH
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_BLEND_DST_RGB
+#define GL_BLEND_DST_RGB 0x80C8
+#endif
+#ifndef GL_BLEND_SRC_RGB
+#define GL_BLEND_SRC_RGB 0x80C9
+#endif
+#ifndef GL_BLEND_DST_ALPHA
+#define GL_BLEND_DST_ALPHA 0x80CA
+#endif
+#ifndef GL_BLEND_SRC_ALPHA
+#define GL_BLEND_SRC_ALPHA 0x80CB
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#endif
+#ifndef GL_TEXTURE1
+#define GL_TEXTURE1 0x84C1
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_R
+#define GL_TEXTURE_SWIZZLE_R 0x8E42
+#define GL_TEXTURE_SWIZZLE_G 0x8E43
+#define GL_TEXTURE_SWIZZLE_B 0x8E44
+#define GL_TEXTURE_SWIZZLE_A 0x8E45
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// Glyphs of dynamic fonts are added to their ImFont with virtual UVs: U in
+// [DYNAMIC_GLYPH_U + 2 * id, DYNAMIC_GLYPH_U + 2 * id + 1] and V in [0, 1] stand
+// for glyphs[id]. Once a frame is built, the glyphs it uses are rasterized into
+// cells of the region reserved in the font atlas and its UVs are rewritten.
+struct ImGui::SFML::ImGuiSFMLContext::DynamicAtlas {
+    struct Font {
+        ImFont* font;         // owning pointer
+        ImFontConfig config;  // font->ConfigData, owns FontData
+        stbtt_fontinfo info;
+        float scale;
+        int cellWidth, cellHeight;  // largest glyph, plus 1 pixel of padding
+    };
+    struct Glyph {
+        int font;           // index in fonts
+        int index;          // stb_truetype glyph index
+        int width, height;  // bitmap size, 0 for blank glyphs
+        int cell;           // index in cells, -1 if not rasterized
+    };
+    struct Cell {
+        int x, y;  // in the region
+        int font;
+        int glyph;  // -1 if free
+        int lastUsedFrame;
+    };
+    struct Upload {
+        int x, y, width, height;  // in the atlas
+        int offset;               // in uploadPixels
+    };
+
+    DynamicAtlas() : regionX(-1), regionY(-1), regionWidth(0), regionHeight(0),
+                     shelvesHeight(0), frame(0) {}
+    ~DynamicAtlas() {
+        for (int i = 0; i < fonts.Size; ++i) {
+            IM_DELETE(fonts[i]->font);
+            IM_FREE(fonts[i]->config.FontData);
+            IM_DELETE(fonts[i]);
+        }
+    }
+
+    ImVector<Font*> fonts;
+    ImVector<Glyph> glyphs;
+    ImVector<Cell> cells;
+    int regionX, regionY;  // -1 if the region isn't in the atlas
+    int regionWidth, regionHeight;
+    int shelvesHeight;  // rows of cells are stacked from the top of the region
+    int frame;
+
+    // cells rasterized since the last render, uploaded by RenderDrawLists
+    // (which may run on another thread, so they're guarded by snapshotMutex)
+    ImVector<Upload> uploads;
+    ImVector<unsigned char> uploadPixels;
+};
+
+// Small textures drawn by the Image/ImageButton overloads are drawn into the
+// pages (sf::RenderTextures), rows of entries are stacked from the top of a
+// page. Pages are only freed as a whole, once none of their entries is used.
+struct ImGui::SFML::ImGuiSFMLContext::TextureAtlas {
+    struct Page {
+        sf::RenderTexture* texture;  // owning pointer, NULL if the slot is free
+        bool smooth;
+        int shelfX, shelfY, shelfHeight;
+        int lastUsedFrame;
+    };
+    struct Entry {
+        const sf::Texture* texture;  // NULL if the slot is free
+        unsigned int glName;         // of the texture when it was copied
+        sf::Vector2u size;
+        int page;  // index in pages
+        int x, y;  // in the page, from its top left corner
+    };
+
+    ~TextureAtlas() {
+        for (int i = 0; i < pages.Size; ++i) {
+            if (pages[i].texture) IM_DELETE(pages[i].texture);
+        }
+    }
+
+    ImVector<Page> pages;
+    ImVector<Entry> entries;
+    ImGuiStorage entrySlots;  // hash of the sf::Texture address -> index in entries + 1
+    ImVector<int> freeEntries;
+};
+
+// Single-producer single-consumer ring buffer: QueueEvent fills entries and
+// then publishes them by moving tail, Update applies them and moves head.
+struct ImGui::SFML::ImGuiSFMLContext::InputQueue {
+    struct Entry {
+        sf::Event event;
+        sf::Int64 time;  // microseconds of clock
+    };
+
+    explicit InputQueue(unsigned int capacity) : head(0), tail(0), dropped(0) {
+        unsigned int size = 1;
+        while (size < capacity) size <<= 1;
+        entries.resize((int)size);
+    }
+
+    ImVector<Entry> entries;
+    std::atomic<unsigned int> head;  // next entry to apply
+    std::atomic<unsigned int> tail;  // next entry to fill
+    std::atomic<unsigned int> dropped;
+    sf::Clock clock;
+};
+
+// Timestamp queries of the last renders, in a ring of query sets: a set is
+// only reused once its results were read back. Query objects aren't shared
+// between GL contexts, they belong to the target's context.
+struct ImGui::SFML::ImGuiSFMLContext::GPUTimer {
+    static const int SET_COUNT = 4;
+    static const int MAX_LISTS = 64;  // timed one by one, renders with more lists are only timed as a whole
+    struct QuerySet {
+        ImVector<unsigned int> queries;  // before the first list, then after each list (or the last one)
+        ImVector<GPUTimings::List> lists;  // owners of the lists, if timed per list
+        int count;                         // queries issued
+        bool pending;                      // issued but not read back yet
+        unsigned int render;
+    };
+
+    // the buffers are allocated up front, so that timing a render never allocates
+    GPUTimer() : next(0), render(0) {
+        for (int i = 0; i < SET_COUNT; ++i) {
+            sets[i].queries.reserve(MAX_LISTS + 1);
+            sets[i].lists.reserve(MAX_LISTS);
+            sets[i].count = 0;
+            sets[i].pending = false;
+            sets[i].render = 0;
+        }
+    }
+
+    QuerySet sets[SET_COUNT];
+    int next;  // set of the next render
+    unsigned int render;
+};
+
+// Frames of a capture: the vertex, index and command buffers of each draw list
+// are XOR-ed with those of the same list in the previous frame (keyframes with
+// nothing), then runs of zero words are skipped. Both the recorder and the
+// replay keep the buffers of the previous frame to do so.
+struct ImGui::SFML::DrawDataCapture {
+    struct List {
+        ImVector<unsigned char> vtx, idx, cmd;  // padded to whole words with zeros
+        ImVector<char> owner;                   // name of the window, NUL-terminated
+    };
+
+    DrawDataCapture() : decodedFrame(-1) {}
+    ~DrawDataCapture() {
+        for (int i = 0; i < lists.Size; ++i) IM_DELETE(lists[i]);
+        for (int i = 0; i < snapshot.lists.Size; ++i) IM_DELETE(snapshot.lists[i]);
+    }
+
+    ImVector<CaptureTexture> textures;
+    ImVector<unsigned char> frames;       // encoded frames, back to back
+    ImVector<unsigned int> frameOffsets;  // in frames, one per frame plus the end
+    ImVector<List*> lists;
+    ImGuiSFMLContext::DrawDataSnapshot snapshot;  // the decoded frame
+    int decodedFrame;                              // -1 if none
+};
+
+struct ImGui::SFML::ImGuiSFMLContext::CaptureRecorder {
+    CaptureRecorder() : next(0), count(0), sinceKeyframe(0), frame(0) {}
+    ~CaptureRecorder() {
+        for (int i = 0; i < frames.Size; ++i) IM_DELETE(frames[i]);
+        for (int i = 0; i < lists.Size; ++i) IM_DELETE(lists[i]);
+    }
+
+    ImVector<ImVector<unsigned char>*> frames;  // ring buffer of encoded frames, owning
+    int next;                                   // slot of the next frame
+    int count;                                  // frames in the ring
+    int sinceKeyframe;                          // 0 forces a keyframe
+    ImVector<DrawDataCapture::List*> lists;     // of the previous frame
+    ImVector<unsigned char> commands;           // scratch buffer
+    int frame;                                  // number of the frame being captured
+
+    // Textures of the frames in the ring. Keyframes free the entries which no frame
+    // in the ring uses any more, and their slots are reused, so the indices held
+    // by the frames stay valid.
+    ImVector<CaptureTexture> textures;
+    ImVector<int> textureLastFrames;  // last frame which used each entry, -1 if free
+    ImVector<int> freeTextures;
+    ImGuiStorage textureSlots;  // hash of the ImTextureID -> index in textures + 1
+};
+
 namespace {
 
+// OpenGL entry points which are not part of OpenGL 1.1, loaded through SFML
+// the first time they are needed (a GL context has to be active then)
+typedef void(APIENTRY* PFN_glGenBuffers)(GLsizei n, GLuint* buffers);
+typedef void(APIENTRY* PFN_glDeleteBuffers)(GLsizei n, const GLuint* buffers);
+typedef void(APIENTRY* PFN_glBindBuffer)(GLenum target, GLuint buffer);
+typedef void(APIENTRY* PFN_glBufferData)(GLenum target, std::ptrdiff_t size,
+                                         const void* data, GLenum usage);
+typedef void(APIENTRY* PFN_glBufferSubData)(GLenum target, std::ptrdiff_t offset,
+                                            std::ptrdiff_t size, const void* data);
+typedef void*(APIENTRY* PFN_glMapBufferRange)(GLenum target, std::ptrdiff_t offset,
+                                              std::ptrdiff_t length, GLbitfield access);
+typedef GLboolean(APIENTRY* PFN_glUnmapBuffer)(GLenum target);
+typedef void(APIENTRY* PFN_glBlendFuncSeparate)(GLenum srcRGB, GLenum dstRGB,
+                                                GLenum srcAlpha, GLenum dstAlpha);
+typedef void(APIENTRY* PFN_glActiveTexture)(GLenum texture);
+typedef void(APIENTRY* PFN_glClientActiveTexture)(GLenum texture);
+
+typedef GLuint(APIENTRY* PFN_glCreateShader)(GLenum type);
+typedef void(APIENTRY* PFN_glShaderSource)(GLuint shader, GLsizei count,
+                                           const char* const* string,
+                                           const GLint* length);
+typedef void(APIENTRY* PFN_glCompileShader)(GLuint shader);
+typedef void(APIENTRY* PFN_glGetShaderiv)(GLuint shader, GLenum pname, GLint* params);
+typedef void(APIENTRY* PFN_glGetShaderInfoLog)(GLuint shader, GLsizei bufSize,
+                                               GLsizei* length, char* infoLog);
+typedef void(APIENTRY* PFN_glDeleteShader)(GLuint shader);
+typedef GLuint(APIENTRY* PFN_glCreateProgram)();
+typedef void(APIENTRY* PFN_glAttachShader)(GLuint program, GLuint shader);
+typedef void(APIENTRY* PFN_glLinkProgram)(GLuint program);
+typedef void(APIENTRY* PFN_glGetProgramiv)(GLuint program, GLenum pname, GLint* params);
+typedef void(APIENTRY* PFN_glGetProgramInfoLog)(GLuint program, GLsizei bufSize,
+                                                GLsizei* length, char* infoLog);
+typedef void(APIENTRY* PFN_glDeleteProgram)(GLuint program);
+typedef void(APIENTRY* PFN_glUseProgram)(GLuint program);
+typedef GLint(APIENTRY* PFN_glGetUniformLocation)(GLuint program, const char* name);
+typedef GLint(APIENTRY* PFN_glGetAttribLocation)(GLuint program, const char* name);
+typedef void(APIENTRY* PFN_glUniform1i)(GLint location, GLint v0);
+typedef void(APIENTRY* PFN_glUniformMatrix4fv)(GLint location, GLsizei count,
+                                               GLboolean transpose, const GLfloat* value);
+typedef void(APIENTRY* PFN_glEnableVertexAttribArray)(GLuint index);
+typedef void(APIENTRY* PFN_glVertexAttribPointer)(GLuint index, GLint size, GLenum type,
+                                                  GLboolean normalized, GLsizei stride,
+                                                  const void* pointer);
+typedef void(APIENTRY* PFN_glGenVertexArrays)(GLsizei n, GLuint* arrays);
+typedef void(APIENTRY* PFN_glDeleteVertexArrays)(GLsizei n, const GLuint* arrays);
+typedef void(APIENTRY* PFN_glBindVertexArray)(GLuint array);
+
+typedef void(APIENTRY* PFN_glGenQueries)(GLsizei n, GLuint* ids);
+typedef void(APIENTRY* PFN_glDeleteQueries)(GLsizei n, const GLuint* ids);
+typedef void(APIENTRY* PFN_glQueryCounter)(GLuint id, GLenum target);
+typedef void(APIENTRY* PFN_glGetQueryObjectuiv)(GLuint id, GLenum pname, GLuint* params);
+typedef void(APIENTRY* PFN_glGetQueryObjectui64v)(GLuint id, GLenum pname,
+                                                  sf::Uint64* params);
+
+struct GLFunctions {
+    int majorVersion;
+    int minorVersion;
+    bool isES;
+
+    bool hasBufferObjects;
+    bool hasMapBufferRange;
+    bool hasShaders; // everything needed by Renderer_Shader
+    bool hasMultitexture;
+    bool hasTextureSwizzle;
+    bool hasTimerQuery;
+    bool timerQueryDisjoint; // through GL_EXT_disjoint_timer_query, see GL_GPU_DISJOINT_EXT
+
+    PFN_glGenBuffers genBuffers;
+    PFN_glDeleteBuffers deleteBuffers;
+    PFN_glBindBuffer bindBuffer;
+    PFN_glBufferData bufferData;
+    PFN_glBufferSubData bufferSubData;
+    PFN_glMapBufferRange mapBufferRange;
+    PFN_glUnmapBuffer unmapBuffer;
+    PFN_glBlendFuncSeparate blendFuncSeparate;
+    PFN_glActiveTexture activeTexture;
+    PFN_glClientActiveTexture clientActiveTexture;
+
+    PFN_glCreateShader createShader;
+    PFN_glShaderSource shaderSource;
+    PFN_glCompileShader compileShader;
+    PFN_glGetShaderiv getShaderiv;
+    PFN_glGetShaderInfoLog getShaderInfoLog;
+    PFN_glDeleteShader deleteShader;
+    PFN_glCreateProgram createProgram;
+    PFN_glAttachShader attachShader;
+    PFN_glLinkProgram linkProgram;
+    PFN_glGetProgramiv getProgramiv;
+    PFN_glGetProgramInfoLog getProgramInfoLog;
+    PFN_glDeleteProgram deleteProgram;
+    PFN_glUseProgram useProgram;
+    PFN_glGetUniformLocation getUniformLocation;
+    PFN_glGetAttribLocation getAttribLocation;
+    PFN_glUniform1i uniform1i;
+    PFN_glUniformMatrix4fv uniformMatrix4fv;
+    PFN_glEnableVertexAttribArray enableVertexAttribArray;
+    PFN_glVertexAttribPointer vertexAttribPointer;
+    PFN_glGenVertexArrays genVertexArrays;
+    PFN_glDeleteVertexArrays deleteVertexArrays;
+    PFN_glBindVertexArray bindVertexArray;
+
+    PFN_glGenQueries genQueries;
+    PFN_glDeleteQueries deleteQueries;
+    PFN_glQueryCounter queryCounter;
+    PFN_glGetQueryObjectuiv getQueryObjectuiv;
+    PFN_glGetQueryObjectui64v getQueryObjectui64v;
+};
+
+const GLFunctions& getGLFunctions();
+void loadGLFunctions(GLFunctions& gl);
+
+// Uploads ImGui's alpha8 font atlas to context.fontAtlasTexture in a format
+// the renderer samples as (1, 1, 1, alpha). Returns false if there is none.
+bool uploadAlpha8FontTexture(ImGui::SFML::ImGuiSFMLContext& context,
+                             const unsigned char* pixels, int width, int height);
+void destroyAlpha8FontTexture(ImGui::SFML::ImGuiSFMLContext& context);
+
+// Builds the font atlas from fontAtlasCachePath if the file was written for
+// the same fonts and settings, or builds it normally and (re)writes the file
+void buildFontAtlasWithCache(ImGui::SFML::ImGuiSFMLContext& context);
+
+typedef ImGui::SFML::ImGuiSFMLContext::DynamicAtlas DynamicAtlas;
+
+// U of the first virtual glyph UV, real UVs are in [0, 1]
+const float DYNAMIC_GLYPH_U = 2.0f;
+
+// Dynamic fonts: the region is a custom rect of the font atlas, added before
+// the atlas is built and found again (emptied) once the texture is created
+void reserveDynamicAtlasRegion(ImGui::SFML::ImGuiSFMLContext& context);
+void resetDynamicAtlas(ImGui::SFML::ImGuiSFMLContext& context);
+
+// Rasterizes the dynamic glyphs used by the frame and rewrites their UVs
+void resolveDynamicGlyphs(ImGui::SFML::ImGuiSFMLContext& context, ImDrawData* draw_data);
+
+// Uploads the cells rasterized by resolveDynamicGlyphs (a GL context has to be active)
+void uploadDynamicGlyphs(ImGui::SFML::ImGuiSFMLContext& context);
+
+// Compiles and links the program of the shader renderer and looks up its
+// uniforms/attributes. Returns false (and logs to sf::err()) on failure.
+bool createShaderObjects(ImGui::SFML::ImGuiSFMLContext& context);
+void destroyShaderObjects(ImGui::SFML::ImGuiSFMLContext& context);
+
+// context whose allocator is used, see ImGuiSFMLContext::allocator. Per
+// thread, like ImGui's current context, with IMGUI_SFML_THREAD_LOCAL_CONTEXT.
+#ifdef IMGUI_SFML_THREAD_LOCAL_CONTEXT
+thread_local
+#endif
+ImGui::SFML::ImGuiSFMLContext* s_currentContext = NULL;
 
+// Makes the context current for ImGui and for allocations
+void setCurrentContext(ImGui::SFML::ImGuiSFMLContext& context);
 
+// ImGui allocation functions, installed by the first Init. They allocate with
+// the current context's allocator and count into its allocationStats.
+void* allocWithCurrentContext(size_t size, void* userData);
+void freeWithOwnAllocator(void* ptr, void* userData);
+// Blocks carry a header telling which allocator they come from, so anything
+// ImGui allocated before this must have been freed already
+void installAllocatorFunctions();
 
 // various helper functions
 ImColor toImColor(sf::Color c);
+ImU32 toImU32(sf::Color c);
 ImVec2 getTopLeftAbsolute(const sf::FloatRect& rect);
 ImVec2 getDownRightAbsolute(const sf::FloatRect& rect);
 
+// DrawVertexArray: x' = a * x + c * y + tx, y' = b * x + d * y + ty
+struct VertexTransform {
+    float a, b, c, d, tx, ty;
+    ImVec2 uv;  // ImGui's white pixel
+};
+// Writes vertices into storage reserved with PrimReserve, positions two at a time with SSE2
+void writeVertices(ImDrawList* draw_list, const sf::Vertex* vertices, int count,
+                   const VertexTransform& transform);
+void drawVertexTriangles(ImDrawList* draw_list, const sf::Vertex* vertices, int count,
+                         sf::PrimitiveType type, const VertexTransform& transform);
+void drawVertexLines(ImDrawList* draw_list, const sf::Vertex* vertices, int count,
+                     sf::PrimitiveType type, const VertexTransform& transform);
+
 ImTextureID convertGLTextureHandleToImTextureID(GLuint glTextureHandle);
 GLuint convertImTextureIDToGLTextureHandle(ImTextureID textureID);
 
-void RenderDrawLists(
-    ImDrawData* draw_data);  // rendering callback function prototype
+// Texture registry: IDs of registered textures have their top bit set, then
+// 11 bits of generation and 20 bits of slot index
+ImGuiID textureSlotKey(const sf::Texture& texture);
+int findTextureSlot(const ImGui::SFML::ImGuiSFMLContext& context, const sf::Texture& texture);
+ImTextureID registerTexture(ImGui::SFML::ImGuiSFMLContext& context, const sf::Texture& texture);
+// Size of a registered texture, false if the ID isn't one or the texture is gone
+bool getRegisteredTextureSize(ImGui::SFML::ImGuiSFMLContext& context, ImTextureID textureID,
+                              sf::Vector2u& size);
+// GL name to bind for a draw command, false if the registered texture is gone
+bool resolveTextureID(ImGui::SFML::ImGuiSFMLContext& context, ImTextureID textureID,
+                      GLuint& glTextureHandle);
+// ID for the Image/ImageButton overloads, which only know ImGui's current context.
+// Turns textureRect into the UVs to draw with, in an atlas page if the texture
+// is atlased (see ImGuiSFMLContext::atlasSmallTextures).
+ImTextureID getTextureIDForCurrentContext(const sf::Texture& texture,
+                                          const sf::FloatRect& textureRect,
+                                          ImVec2& uv0, ImVec2& uv1);
+
+typedef ImGui::SFML::ImGuiSFMLContext::TextureAtlas TextureAtlas;
+
+// Texture atlasing: returns false if the texture can't be atlased. Otherwise
+// copies it into a page if it isn't there yet and maps uv0/uv1 into the page.
+bool atlasTexture(ImGui::SFML::ImGuiSFMLContext& context, const sf::Texture& texture,
+                  ImVec2& uv0, ImVec2& uv1, ImTextureID& textureID);
+int findAtlasEntry(const TextureAtlas& atlas, const sf::Texture& texture);
+void removeAtlasEntry(TextureAtlas& atlas, int index);
+void freeAtlasPage(ImGui::SFML::ImGuiSFMLContext& context, int index);
+// Frees the pages none of whose entries were drawn for atlasEvictFrames frames
+// (or the least recently used page, if force is set and no page is stale)
+bool evictAtlasPages(ImGui::SFML::ImGuiSFMLContext& context, bool force);
+
+void RenderDrawLists(ImGui::SFML::ImGuiSFMLContext& context,
+                     ImDrawData* draw_data,
+                     const ImVec2& framebufferScale);  // rendering callback function prototype
+
+typedef ImGui::SFML::ImGuiSFMLContext::DrawDataSnapshot DrawDataSnapshot;
+
+void copyDrawData(DrawDataSnapshot& snapshot, const ImDrawData* draw_data,
+                  const ImVec2& framebufferScale);
+void destroySnapshot(DrawDataSnapshot& snapshot);
+
+// Ends the frame started by Update: returns the draw data of the frame which was
+// just built, or the copy of the last built one
+ImDrawData* endFrame(ImGui::SFML::ImGuiSFMLContext& context);
+
+typedef ImGui::SFML::ImGuiSFMLContext::FrameProfile FrameProfile;
+
+// Adds the time from its construction (or from the last next()) to a phase of
+// the frame being profiled, or of the next frame if pending is set. Does
+// nothing if the profiler is disabled.
+class ProfileTimer {
+public:
+    ProfileTimer(ImGui::SFML::ImGuiSFMLContext& context, float FrameProfile::*phase,
+                 bool pending = false, unsigned int FrameProfile::*counter = NULL)
+        : context(context), phase(phase), counter(counter), pending(pending),
+          enabled(context.enableProfiler) {
+        if (enabled) start = std::chrono::steady_clock::now();
+    }
+    ~ProfileTimer() { next(NULL); }
+
+    void next(float FrameProfile::*nextPhase) {
+        if (!enabled || !phase) {
+            phase = nextPhase;
+            return;
+        }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(context.snapshotMutex);
+            FrameProfile& profile = pending ? context.profilerPending : context.profilerFrame;
+            profile.*phase += std::chrono::duration<float, std::milli>(now - start).count();
+            if (counter) {
+                ++(profile.*counter);
+                counter = NULL;
+            }
+        }
+        phase = nextPhase;
+        start = now;
+    }
+
+private:
+    ImGui::SFML::ImGuiSFMLContext& context;
+    float FrameProfile::*phase;
+    unsigned int FrameProfile::*counter;
+    bool pending;
+    bool enabled;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Closes the profile of the frame which was being built and starts a new one
+void beginFrameProfile(ImGui::SFML::ImGuiSFMLContext& context);
+// Adds the counters of a submission to the frame being profiled
+void recordSubmitProfile(ImGui::SFML::ImGuiSFMLContext& context, const ImDrawData* draw_data);
+
+typedef ImGui::SFML::ImGuiSFMLContext::GPUTimer GPUTimer;
+
+// GPU timing: reads back the query sets whose results are available, then
+// issues the first timestamp of this render. Returns NULL if the render isn't
+// timed (timer queries unavailable, or the GPU is SET_COUNT renders behind).
+GPUTimer* beginGPUTiming(ImGui::SFML::ImGuiSFMLContext& context, const ImDrawData* draw_data);
+void queryGPUTimestamp(GPUTimer& timer);
+void endGPUTiming(GPUTimer& timer);
+void readGPUTimings(ImGui::SFML::ImGuiSFMLContext& context, GPUTimer& timer);
+void destroyGPUTimer(ImGui::SFML::ImGuiSFMLContext& context);
+
+typedef ImGui::SFML::DrawDataCapture DrawDataCapture;
+typedef ImGui::SFML::ImGuiSFMLContext::CaptureRecorder CaptureRecorder;
+
+// Capture: encodes a frame built by ImGui into the recorder's ring buffer
+void captureDrawData(ImGui::SFML::ImGuiSFMLContext& context, const ImDrawData* draw_data);
+bool writeCapture(const CaptureRecorder& recorder, const char* filename);
+bool readCapture(DrawDataCapture& capture, const char* filename);
+// Decodes a frame into capture.snapshot, the previous one must have been decoded
+// unless the frame is a keyframe
+bool decodeCaptureFrame(DrawDataCapture& capture, int frame);
+bool isCaptureKeyframe(const unsigned char* frame, std::size_t size);
+bool isCaptureListValid(const ImDrawList& list);
+
+// Software rendering: converts the draw lists into triangles clipped to their
+// scissor rect, then rasterizes horizontal bands of the image in parallel
+void setupSoftwareTriangles(ImGui::SFML::ImGuiSFMLContext& context,
+                            const ImDrawData* draw_data, const ImVec2& framebufferScale,
+                            int width, int height);
+void rasterizeBand(const ImGui::SFML::ImGuiSFMLContext::SoftwareTriangle* triangles,
+                   int count, unsigned int* pixels, int width, int yBegin, int yEnd);
+// Rasterizes the bands after the first one on the worker threads, which are
+// started on first use, while the calling thread does the first band
+void rasterizeBands(ImGui::SFML::ImGuiSFMLContext& context, unsigned int* pixels, int width,
+                    int height, int bandCount);
+void destroySoftwareWorkers(ImGui::SFML::ImGuiSFMLContext& context);
+
+// Calls resetGLStates on the target, or remembers its viewport if
+// minimalGLStateChanges is set
+void prepareRenderTarget(ImGui::SFML::ImGuiSFMLContext& context,
+                         sf::RenderTarget& target);
+
+// Fingerprint of everything that ends up on screen. Returns false if the
+// draw data can't be cached (user callbacks).
+bool hashDrawData(const ImGuiIO& io, const ImDrawData* draw_data,
+                  unsigned long long& hash);
+
+// Redraws context.renderCache if the draw data changed and composites it onto
+// the target. Returns false if the frame has to be drawn directly.
+bool renderCachedDrawData(ImGui::SFML::ImGuiSFMLContext& context,
+                          sf::RenderTarget& target, ImDrawData* draw_data);
+
+// Copies the vertices and indices of all CmdLists into the streaming buffers.
+// Returns false if buffer objects can't be used with the current GL context.
+bool uploadDrawData(ImGui::SFML::ImGuiSFMLContext& context,
+                    const ImDrawData* draw_data, std::size_t& vtxStart,
+                    std::size_t& idxStart);
 
 // Implementation of ImageButton overload
 bool imageButtonImpl(const sf::Texture& texture,
@@ -142,10 +809,31 @@ void initDefaultJoystickMapping(ImGui::SFML::ImGuiSFMLContext& context);
 // Returns first id of connected joystick
 unsigned int getConnectedJoystickId();
 
+// Joystick state of the active joystick, from events or polled (see pollInputDevices)
+bool isJoystickButtonPressed(ImGui::SFML::ImGuiSFMLContext& context, unsigned int button);
+float getJoystickAxisPosition(ImGui::SFML::ImGuiSFMLContext& context, sf::Joystick::Axis axis);
+void setActiveJoystick(ImGui::SFML::ImGuiSFMLContext& context, unsigned int joystickId);
+void countInputQueries(ImGui::SFML::ImGuiSFMLContext& context, unsigned int count);
+// Touch or mouse position in the window, from events unless pollInputDevices is set
+sf::Vector2i getWindowMousePosition(ImGui::SFML::ImGuiSFMLContext& context, const sf::Window& window);
+
 void updateJoystickActionState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io, ImGuiNavInput_ action);
 void updateJoystickDPadState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io);
 void updateJoystickLStickState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io);
 
+// Longest time the app can idle before a new frame is needed, sf::Time::Zero
+// if one is needed now. Returns false if there's no limit.
+bool getIdleTimeout(ImGui::SFML::ImGuiSFMLContext& context, sf::Time& timeout);
+
+// Updates the context and ImGui's io with an event, see ProcessEvent
+bool applyEvent(ImGui::SFML::ImGuiSFMLContext& context, const sf::Event& event);
+
+typedef ImGui::SFML::ImGuiSFMLContext::InputQueue InputQueue;
+
+// Applies the queued events in order, up to the first one which changes a key
+// or button that already changed (or moves the mouse after a click)
+void applyQueuedEvents(ImGui::SFML::ImGuiSFMLContext& context);
+
 // clipboard functions
 void setClipboardText(void* userData, const char* text);
 const char* getClipboadText(void* userData);
@@ -163,6 +851,18 @@ namespace SFML {
 const unsigned int NULL_JOYSTICK_ID = sf::Joystick::Count;
 const unsigned int NULL_JOYSTICK_BUTTON = sf::Joystick::ButtonCount;
 
+namespace {
+// frames IsFrameNeeded asks for after a relevant event
+const int IDLE_SETTLE_FRAMES = 3;
+// mousePosition after a MouseLeft event, given to ImGui as no mouse
+const sf::Vector2i MOUSE_OUTSIDE(INT_MIN, INT_MIN);
+
+// Update with the mouse position of the window, if one is given: it's read
+// once the queued events of the frame are applied
+bool update(ImGuiSFMLContext& context, const sf::Window* window, sf::Vector2i mousePos,
+            const sf::Vector2f& displaySize, sf::Time dt);
+}
+
 void Init(ImGuiSFMLContext& context, sf::RenderWindow& window, bool loadDefaultFont) {
     Init(context, window, window, loadDefaultFont);
 }
@@ -171,6 +871,52 @@ void Init(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& targe
     Init(context, window, static_cast<sf::Vector2f>(target.getSize()), loadDefaultFont);
 }
 
+void Init(ImGuiSFMLContext& context, sf::RenderWindow& window, SharedFontAtlas& sharedFonts) {
+    Init(context, window, window, sharedFonts);
+}
+
+void Init(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& target,
+          SharedFontAtlas& sharedFonts) {
+    context.sharedFontAtlas = &sharedFonts;
+    Init(context, window, static_cast<sf::Vector2f>(target.getSize()), false);
+}
+
+SharedFontAtlas* CreateSharedFontAtlas(bool loadDefaultFont) {
+    installAllocatorFunctions();
+    SharedFontAtlas* sharedFonts = IM_NEW(SharedFontAtlas);
+    sharedFonts->thread = std::this_thread::get_id();
+    sharedFonts->atlas = IM_NEW(ImFontAtlas);
+    sharedFonts->texture = IM_NEW(sf::Texture);
+    if (loadDefaultFont) {
+        sharedFonts->atlas->AddFontDefault();
+        UpdateSharedFontTexture(*sharedFonts);
+    }
+    return sharedFonts;
+}
+
+void ReleaseSharedFontAtlas(SharedFontAtlas* sharedFonts) {
+    if (!sharedFonts || --sharedFonts->refCount > 0) {
+        return;
+    }
+    IM_DELETE(sharedFonts->texture);
+    IM_DELETE(sharedFonts->atlas);
+    IM_DELETE(sharedFonts);
+}
+
+void UpdateSharedFontTexture(SharedFontAtlas& sharedFonts) {
+    unsigned char* pixels;
+    int width, height;
+    sharedFonts.atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    sf::Texture& texture = *sharedFonts.texture;
+    texture.create(width, height);
+    texture.update(pixels);
+
+    // a GL name, which all the contexts can resolve
+    sharedFonts.atlas->TexID =
+        convertGLTextureHandleToImTextureID(texture.getNativeHandle());
+}
+
 void Init(ImGuiSFMLContext& context, sf::Window& window, const sf::Vector2f& displaySize, bool loadDefaultFont) {
 #if __cplusplus < 201103L  // runtime assert when using earlier than C++11 as no
                            // static_assert support
@@ -179,14 +925,32 @@ void Init(ImGuiSFMLContext& context, sf::Window& window, const sf::Vector2f& dis
         sizeof(ImTextureID));  // ImTextureID is not large enough to fit GLuint.
 #endif
 
-    context.imguiContext = ImGui::CreateContext();
+    installAllocatorFunctions();
+    if ((context.allocator.allocFunc == NULL) != (context.allocator.freeFunc == NULL)) {
+        sf::err() << "ImGui-SFML: allocator needs both allocFunc and freeFunc, "
+                     "using malloc/free"
+                  << std::endl;
+        context.allocator = ImGuiSFMLContext::Allocator();
+    }
+
+    s_currentContext = &context;
+    context.imguiContext =
+        ImGui::CreateContext(context.sharedFontAtlas ? context.sharedFontAtlas->atlas : NULL);
+    ImGui::SetCurrentContext(context.imguiContext);
     ImGuiIO& io = context.imguiContext->IO;
 
     // tell ImGui which features we support
     io.BackendFlags |= ImGuiBackendFlags_HasGamepad;
     io.BackendFlags |= ImGuiBackendFlags_HasMouseCursors;
     io.BackendFlags |= ImGuiBackendFlags_HasSetMousePos;
+#if IMGUI_VERSION_NUM >= 17100
+    // draw lists can then grow past 64k vertices with 16-bit indices
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+#endif
     io.BackendPlatformName = "imgui_impl_sfml";
+    io.BackendPlatformUserData = &context;
+
+    context.framesPending = IDLE_SETTLE_FRAMES;
 
     // init keyboard mapping
     io.KeyMap[ImGuiKey_Tab] = sf::Keyboard::Tab;
@@ -215,7 +979,7 @@ void Init(ImGuiSFMLContext& context, sf::Window& window, const sf::Vector2f& dis
     io.KeyMap[ImGuiKey_Y] = sf::Keyboard::Y;
     io.KeyMap[ImGuiKey_Z] = sf::Keyboard::Z;
 
-    context.joystickId = getConnectedJoystickId();
+    setActiveJoystick(context, getConnectedJoystickId());
 
     for (unsigned int i = 0; i < ImGuiNavInput_COUNT; i++) {
         context.joystickMapping[i] = NULL_JOYSTICK_BUTTON;
@@ -226,6 +990,30 @@ void Init(ImGuiSFMLContext& context, sf::Window& window, const sf::Vector2f& dis
     // init rendering
     io.DisplaySize = ImVec2(displaySize.x, displaySize.y);
 
+    if (context.renderer == Renderer_Shader) {
+        window.setActive(true);
+        if (!createShaderObjects(context)) {
+            context.renderer = Renderer_FixedFunction;
+        }
+    }
+    io.BackendRendererName = context.renderer == Renderer_Shader
+                                 ? "imgui_impl_sfml_shader"
+                                 : "imgui_impl_sfml";
+
+    if (context.inputQueue) {
+        IM_DELETE(context.inputQueue);
+        context.inputQueue = NULL;
+    }
+    if (context.queueInput) {
+        context.inputQueue = IM_NEW(InputQueue)(context.inputQueueCapacity);
+    }
+
+    // the render path doesn't allocate, as RenderSnapshot may run on another thread
+    if (context.gpuTiming && !context.gpuTimer) {
+        context.gpuTimer = IM_NEW(GPUTimer)();
+        context.gpuTimings.lists.reserve(GPUTimer::MAX_LISTS);
+    }
+
     // clipboard
     io.SetClipboardTextFn = setClipboardText;
     io.GetClipboardTextFn = getClipboadText;
@@ -247,10 +1035,15 @@ void Init(ImGuiSFMLContext& context, sf::Window& window, const sf::Vector2f& dis
                     sf::Cursor::SizeTopLeftBottomRight);
     loadMouseCursor(context, ImGuiMouseCursor_Hand, sf::Cursor::Hand);
 
-    if (context.fontTexture) {  // delete previously created texture
-        delete context.fontTexture;
+    if (context.sharedFontAtlas) {
+        ++context.sharedFontAtlas->refCount;
+        context.fontTexture = context.sharedFontAtlas->texture;
+    } else {
+        if (context.fontTexture) {  // delete previously created texture
+            IM_DELETE(context.fontTexture);
+        }
+        context.fontTexture = IM_NEW(sf::Texture);
     }
-    context.fontTexture = new sf::Texture;
 
     if (loadDefaultFont) {
         // this will load default font automatically
@@ -261,109 +1054,121 @@ void Init(ImGuiSFMLContext& context, sf::Window& window, const sf::Vector2f& dis
     context.windowHasFocus = window.hasFocus();
 }
 
-void ProcessEvent(ImGuiSFMLContext& context, const sf::Event& event) {
-    if (context.windowHasFocus) {
-        ImGuiIO& io = context.imguiContext->IO;
+bool ProcessEvent(ImGuiSFMLContext& context, const sf::Event& event) {
+    ProfileTimer timer(context, &FrameProfile::processEventMs, true, &FrameProfile::events);
+    if (context.inputQueue) {
+        return QueueEvent(context, event);
+    }
+    return applyEvent(context, event);
+}
 
-        switch (event.type) {
-            case sf::Event::MouseMoved:
-                context.mouseMoved = true;
-                break;
-            case sf::Event::MouseButtonPressed:  // fall-through
-            case sf::Event::MouseButtonReleased: {
-                int button = event.mouseButton.button;
-                if (event.type == sf::Event::MouseButtonPressed &&
-                    button >= 0 && button < 3) {
-                    context.mousePressed[event.mouseButton.button] = true;
-                }
-            } break;
-            case sf::Event::TouchBegan:  // fall-through
-            case sf::Event::TouchEnded: {
-                context.mouseMoved = false;
-                int button = event.touch.finger;
-                if (event.type == sf::Event::TouchBegan && button >= 0 &&
-                    button < 3) {
-                    context.touchDown[event.touch.finger] = true;
-                }
-            } break;
-            case sf::Event::MouseWheelScrolled:
-                if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel ||
-                    (event.mouseWheelScroll.wheel == sf::Mouse::HorizontalWheel &&
-                    io.KeyShift)) {
-                    io.MouseWheel += event.mouseWheelScroll.delta;
-                } else if (event.mouseWheelScroll.wheel == sf::Mouse::HorizontalWheel) {
-                    io.MouseWheelH += event.mouseWheelScroll.delta;
-                }
-                break;
-            case sf::Event::KeyPressed:  // fall-through
-            case sf::Event::KeyReleased:
-                io.KeysDown[event.key.code] =
-                    (event.type == sf::Event::KeyPressed);
-                break;
-            case sf::Event::TextEntered:
-                // Don't handle the event for unprintable characters
-                if (event.text.unicode < ' ' || event.text.unicode == 127) {
-                    break;
-                }
-                io.AddInputCharacter(event.text.unicode);
-                break;
-            case sf::Event::JoystickConnected:
-                if (context.joystickId == NULL_JOYSTICK_ID) {
-                    context.joystickId = event.joystickConnect.joystickId;
-                }
-                break;
-            case sf::Event::JoystickDisconnected:
-                if (context.joystickId ==
-                    event.joystickConnect
-                        .joystickId) {  // used gamepad was disconnected
-                    context.joystickId = getConnectedJoystickId();
-                }
-                break;
-            default:
-                break;
-        }
+bool QueueEvent(ImGuiSFMLContext& context, const sf::Event& event) {
+    InputQueue* queue = context.inputQueue;
+    if (!queue) {
+        return false;
+    }
+    unsigned int tail = queue->tail.load(std::memory_order_relaxed);
+    unsigned int head = queue->head.load(std::memory_order_acquire);
+    if (tail - head >= (unsigned int)queue->entries.Size) {
+        queue->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
+    InputQueue::Entry& entry = queue->entries[tail & (queue->entries.Size - 1)];
+    entry.event = event;
+    entry.time = queue->clock.getElapsedTime().asMicroseconds();
+    queue->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
 
-    switch (event.type) {
-        case sf::Event::LostFocus:
-            context.windowHasFocus = false;
-            break;
-        case sf::Event::GainedFocus:
-            context.windowHasFocus = true;
-            break;
-        default:
-            break;
+bool IsFrameNeeded(ImGuiSFMLContext& context) {
+    sf::Time timeout;
+    return getIdleTimeout(context, timeout) && timeout == sf::Time::Zero;
+}
+
+bool WaitEvent(ImGuiSFMLContext& context, sf::Window& window, sf::Event& event) {
+    for (;;) {
+        if (window.pollEvent(event)) {
+            return true;
+        }
+
+        sf::Time timeout;
+        if (!getIdleTimeout(context, timeout)) {
+            // nothing to animate: sleep until the next event
+            return window.waitEvent(event);
+        }
+        if (timeout == sf::Time::Zero) {
+            return false;
+        }
+        // SFML can't wait for events with a timeout. It polls every 10 ms
+        // in waitEvent too, so this isn't any less responsive.
+        sf::sleep(std::min(timeout, sf::milliseconds(10)));
     }
 }
 
-void Update(ImGuiSFMLContext& context, sf::RenderWindow& window, sf::Time dt) {
-    Update(context, window, window, dt);
+bool Update(ImGuiSFMLContext& context, sf::RenderWindow& window, sf::Time dt) {
+    return Update(context, window, window, dt);
 }
 
-void Update(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& target, sf::Time dt) {
+bool Update(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& target, sf::Time dt) {
+    setCurrentContext(context);
 	ImGuiIO& io = context.imguiContext->IO;
     // Update OS/hardware mouse cursor if imgui isn't drawing a software cursor
-    updateMouseCursor(context, window);
-
-    if (!context.mouseMoved) {
-        if (sf::Touch::isDown(0))
-            context.touchPos = sf::Touch::getPosition(0, window);
-
-        Update(context, context.touchPos, static_cast<sf::Vector2f>(target.getSize()), dt);
-    } else {
-        Update(context, sf::Mouse::getPosition(window),
-               static_cast<sf::Vector2f>(target.getSize()), dt);
+    {
+        ProfileTimer timer(context, &FrameProfile::mouseCursorMs, true);
+        updateMouseCursor(context, window);
     }
 
+    bool frameBuilt = update(context, &window, sf::Vector2i(),
+                             static_cast<sf::Vector2f>(target.getSize()), dt);
+
     if (io.MouseDrawCursor) {
         // Hide OS mouse cursor if imgui is drawing it
         window.setMouseCursorVisible(false);
     }
+    return frameBuilt;
 }
 
-void Update(ImGuiSFMLContext& context, const sf::Vector2i& mousePos, const sf::Vector2f& displaySize,
+bool Update(ImGuiSFMLContext& context, const sf::Vector2i& mousePos, const sf::Vector2f& displaySize,
             sf::Time dt) {
+    return update(context, NULL, mousePos, displaySize, dt);
+}
+
+namespace {
+bool update(ImGuiSFMLContext& context, const sf::Window* window, sf::Vector2i mousePos,
+            const sf::Vector2f& displaySize, sf::Time dt) {
 	ImGuiIO& io = context.imguiContext->IO;
+
+    // between rebuilds, events keep accumulating in io and the context
+    // (pressed buttons, characters, wheel) until the next NewFrame
+    context.timeSinceUpdate += dt;
+    context.frameBuilt = context.timeSinceUpdate >= context.updateInterval ||
+                         !context.drawDataCopy.data.Valid;
+    if (!context.frameBuilt) {
+        return false;
+    }
+    dt = context.timeSinceUpdate;
+    context.timeSinceUpdate = sf::Time::Zero;
+    context.allocationStats.frameAllocations = 0;
+    context.allocationStats.frameBytes = 0;
+    context.inputStats.frameQueries = 0;
+    if (context.enableProfiler) {
+        beginFrameProfile(context);
+    }
+    ProfileTimer timer(context, &FrameProfile::inputMs);
+
+    // before the input state is read below
+    if (context.inputQueue) {
+        applyQueuedEvents(context);
+    }
+    if (window) {
+        mousePos = getWindowMousePosition(context, *window);
+    }
+
+    if (context.framesPending > 0) {
+        --context.framesPending;
+    }
+    context.idleClock.restart();
+
     io.DisplaySize = ImVec2(displaySize.x, displaySize.y);
     
     io.DeltaTime = dt.asSeconds();
@@ -373,13 +1178,22 @@ void Update(ImGuiSFMLContext& context, const sf::Vector2i& mousePos, const sf::V
             sf::Vector2i mousePos(static_cast<int>(io.MousePos.x),
                                   static_cast<int>(io.MousePos.y));
             sf::Mouse::setPosition(mousePos);
+            context.mousePosition = mousePos;  // no MouseMoved event may follow
         } else {
-            io.MousePos = ImVec2(mousePos.x, mousePos.y);
+            io.MousePos = mousePos == MOUSE_OUTSIDE ? ImVec2(-FLT_MAX, -FLT_MAX)
+                                                    : ImVec2(mousePos.x, mousePos.y);
         }
         for (unsigned int i = 0; i < 3; i++) {
-            io.MouseDown[i] = context.touchDown[i] || sf::Touch::isDown(i) ||
-                              context.mousePressed[i] ||
-                              sf::Mouse::isButtonPressed((sf::Mouse::Button)i);
+            bool held;
+            if (context.pollInputDevices) {
+                held = sf::Touch::isDown(i) ||
+                       sf::Mouse::isButtonPressed((sf::Mouse::Button)i);
+                countInputQueries(context, 2);
+            } else {
+                held = context.touchHeld[i] || context.mouseHeld[i];
+            }
+            // pressed and released since the last frame still makes a click
+            io.MouseDown[i] = context.touchDown[i] || context.mousePressed[i] || held;
             context.mousePressed[i] = false;
             context.touchDown[i] = false;
         }
@@ -413,6 +1227,7 @@ void Update(ImGuiSFMLContext& context, const sf::Vector2i& mousePos, const sf::V
                                        // atlas (see createFontTexture)
 
     // gamepad navigation
+    timer.next(&FrameProfile::gamepadMs);
     if ((io.ConfigFlags & ImGuiConfigFlags_NavEnableGamepad) &&
         context.joystickId != NULL_JOYSTICK_ID) {
         updateJoystickActionState(context, io, ImGuiNavInput_Activate);
@@ -430,64 +1245,605 @@ void Update(ImGuiSFMLContext& context, const sf::Vector2i& mousePos, const sf::V
         updateJoystickLStickState(context, io);
     }
 
-    ImGui::SetCurrentContext(context.imguiContext);
+    timer.next(&FrameProfile::newFrameMs);
+    if (context.textureAtlas) {
+        evictAtlasPages(context, false);
+    }
+
+    // the shared atlas is written without a lock
+    assert(!context.sharedFontAtlas ||
+           context.sharedFontAtlas->thread == std::this_thread::get_id());
+    setCurrentContext(context);
     ImGui::NewFrame();
+    return true;
+}
+}  // end of anonymous namespace
+
+void SetUpdateRate(ImGuiSFMLContext& context, float rate) {
+    context.updateInterval = rate > 0.f ? sf::seconds(1.f / rate) : sf::Time::Zero;
+    if (context.updateInterval == sf::Time::Zero) {
+        destroySnapshot(context.drawDataCopy);
+    }
 }
 
 void Render(ImGuiSFMLContext& context, sf::RenderTarget& target) {
-    target.resetGLStates();
+    if (context.cacheRendering) {
+        ImDrawData* draw_data = endFrame(context);
+        if (!renderCachedDrawData(context, target, draw_data)) {
+            prepareRenderTarget(context, target);
+            RenderDrawLists(context, draw_data,
+                            context.imguiContext->IO.DisplayFramebufferScale);
+        }
+        return;
+    }
+
+    prepareRenderTarget(context, target);
     Render(context);
 }
 
 void Render(ImGuiSFMLContext& context) {
-	ImGui::SetCurrentContext(context.imguiContext);
-    ImGui::Render();
-    RenderDrawLists(ImGui::GetDrawData());
+    ImDrawData* draw_data = endFrame(context);
+    RenderDrawLists(context, draw_data, context.imguiContext->IO.DisplayFramebufferScale);
 }
 
-void Shutdown(ImGuiSFMLContext& context) {
-	ImGuiIO& io = context.imguiContext->IO;
-    io.Fonts->TexID = (ImTextureID)NULL;
+void SubmitSnapshot(ImGuiSFMLContext& context) {
+    ImDrawData* draw_data = endFrame(context);
 
-    if (context.fontTexture) {  // if internal texture was created, we delete it
-        delete context.fontTexture;
-        context.fontTexture = NULL;
+    // the snapshot RenderSnapshot may be drawing is left alone. An older
+    // submission which wasn't picked yet is overwritten.
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(context.snapshotMutex);
+        index = context.snapshotRendered == 0 ? 1 : 0;
+        context.snapshotReady = -1;
     }
 
-    for (int i = 0; i < ImGuiMouseCursor_COUNT; ++i) {
-        if (context.mouseCursorLoaded[i]) {
-            delete context.mouseCursors[i];
-            context.mouseCursors[i] = NULL;
+    copyDrawData(context.snapshots[index], draw_data,
+                 context.imguiContext->IO.DisplayFramebufferScale);
 
-            context.mouseCursorLoaded[i] = false;
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    context.snapshotReady = index;
+}
+
+void RenderSnapshot(ImGuiSFMLContext& context, sf::RenderTarget& target) {
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(context.snapshotMutex);
+        if (context.snapshotReady != -1) {
+            context.snapshotRendered = context.snapshotReady;
+            context.snapshotReady = -1;
         }
+        index = context.snapshotRendered;
+    }
+    if (index == -1) {
+        return;  // nothing submitted yet
     }
 
-	ImGui::SetCurrentContext(context.imguiContext);
-    ImGui::DestroyContext();
-    context.imguiContext = NULL;
+    prepareRenderTarget(context, target);
+    DrawDataSnapshot& snapshot = context.snapshots[index];
+    RenderDrawLists(context, &snapshot.data, snapshot.framebufferScale);
 }
 
-void UpdateFontTexture(ImGuiSFMLContext& context) {
-	ImGuiIO& io = context.imguiContext->IO;
-    unsigned char* pixels;
-    int width, height;
+void RenderDrawData(ImGuiSFMLContext& context, sf::RenderTarget& target, ImDrawData* drawData) {
+    prepareRenderTarget(context, target);
+    RenderDrawLists(context, drawData, context.imguiContext->IO.DisplayFramebufferScale);
+}
 
-    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+bool SaveCapture(ImGuiSFMLContext& context, const char* filename) {
+    if (!context.captureRecorder || context.captureRecorder->count == 0) {
+        return false;
+    }
+    if (!writeCapture(*context.captureRecorder, filename)) {
+        sf::err() << "ImGui-SFML: failed to write the capture " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    sf::Texture& texture = *context.fontTexture;
-    texture.create(width, height);
-    texture.update(pixels);
+DrawDataCapture* LoadCapture(const char* filename) {
+    DrawDataCapture* capture = IM_NEW(DrawDataCapture)();
+    if (!readCapture(*capture, filename)) {
+        sf::err() << "ImGui-SFML: can't read the capture " << filename << std::endl;
+        IM_DELETE(capture);
+        return NULL;
+    }
+    return capture;
+}
 
-    io.Fonts->TexID =
-        convertGLTextureHandleToImTextureID(texture.getNativeHandle());
+void DestroyCapture(DrawDataCapture* capture) {
+    if (capture) {
+        IM_DELETE(capture);
+    }
 }
 
-sf::Texture& GetFontTexture(ImGuiSFMLContext& context) { return *context.fontTexture; }
+int GetCaptureFrameCount(const DrawDataCapture& capture) {
+    return capture.frameOffsets.Size - 1;
+}
+
+int GetCaptureTextureCount(const DrawDataCapture& capture) {
+    return capture.textures.Size;
+}
+
+CaptureTexture& GetCaptureTexture(DrawDataCapture& capture, int index) {
+    return capture.textures[index];
+}
+
+const ImGuiSFMLContext::DrawDataSnapshot* GetCaptureFrame(DrawDataCapture& capture, int index) {
+    if (index < 0 || index >= GetCaptureFrameCount(capture)) {
+        return NULL;
+    }
+
+    // frames in between are decoded too, from the last decoded one if it's closer
+    int keyframe = index;
+    while (keyframe > 0 &&
+           !isCaptureKeyframe(capture.frames.Data + capture.frameOffsets[keyframe],
+                              capture.frameOffsets[keyframe + 1] - capture.frameOffsets[keyframe])) {
+        --keyframe;
+    }
+    int first = capture.decodedFrame >= keyframe && capture.decodedFrame < index
+                    ? capture.decodedFrame + 1
+                    : keyframe;
+    for (int frame = first; frame <= index; ++frame) {
+        if (!decodeCaptureFrame(capture, frame)) {
+            capture.decodedFrame = -1;
+            return NULL;
+        }
+        capture.decodedFrame = frame;
+    }
+    return &capture.snapshot;
+}
+
+void RenderToImage(ImGuiSFMLContext& context, sf::Image& image, const sf::Color& clearColor) {
+    ImDrawData* draw_data = endFrame(context);
+    const ImVec2& framebufferScale = context.imguiContext->IO.DisplayFramebufferScale;
+    int width = static_cast<int>(draw_data->DisplaySize.x * framebufferScale.x);
+    int height = static_cast<int>(draw_data->DisplaySize.y * framebufferScale.y);
+    if (width <= 0 || height <= 0) {
+        image.create(0, 0);
+        return;
+    }
+
+    // same byte order as sf::Image (and ImGui's RGBA32 atlas on little-endian)
+    unsigned int clear = clearColor.r | (clearColor.g << 8) | (clearColor.b << 16) |
+                         ((unsigned int)clearColor.a << 24);
+    ImVector<unsigned int>& pixels = context.softwarePixels;
+    pixels.resize(width * height);
+    std::fill(pixels.Data, pixels.Data + pixels.Size, clear);
+
+    // the rasterizer samples RGBA32 texels. An alpha8 atlas (alpha8FontAtlas)
+    // converts them, and keeps them, the first time.
+    ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    if (!fonts->TexPixelsRGBA32 && fonts->TexPixelsAlpha8) {
+        unsigned char* rgbaPixels;
+        int atlasWidth, atlasHeight;
+        fonts->GetTexDataAsRGBA32(&rgbaPixels, &atlasWidth, &atlasHeight);
+    }
+
+    setupSoftwareTriangles(context, draw_data, framebufferScale, width, height);
+
+    // bands of at least 32 rows, so that each thread has enough to do
+    const int MAX_THREADS = 64;
+    int threadCount = context.softwareThreads
+                          ? (int)context.softwareThreads
+                          : (int)std::thread::hardware_concurrency();
+    threadCount = std::max(1, std::min(std::min(threadCount, MAX_THREADS), height / 32));
+
+    rasterizeBands(context, pixels.Data, width, height, threadCount);
+
+    image.create(width, height, reinterpret_cast<const sf::Uint8*>(pixels.Data));
+}
+
+void SetSoftwareTexture(ImGuiSFMLContext& context, const sf::Texture& texture, const sf::Image* image) {
+    ImTextureID id = registerTexture(context, texture);
+    ImVector<ImGuiSFMLContext::SoftwareTexture>& textures = context.softwareTextures;
+    for (int i = 0; i < textures.Size; ++i) {
+        if (textures[i].id == id) {
+            if (image) {
+                textures[i].image = image;
+            } else {
+                textures[i] = textures.back();
+                textures.pop_back();
+            }
+            return;
+        }
+    }
+    if (image) {
+        ImGuiSFMLContext::SoftwareTexture entry;
+        entry.id = id;
+        entry.image = image;
+        textures.push_back(entry);
+    }
+}
+
+void Shutdown(ImGuiSFMLContext& context) {
+    setCurrentContext(context);
+	ImGuiIO& io = context.imguiContext->IO;
+
+    if (context.sharedFontAtlas) {  // still used by the other contexts
+        context.fontTexture = NULL;
+    } else {
+        io.Fonts->TexID = (ImTextureID)NULL;
+    }
+    if (context.fontTexture) {  // if internal texture was created, we delete it
+        IM_DELETE(context.fontTexture);
+        context.fontTexture = NULL;
+    }
+    destroyAlpha8FontTexture(context);
+    context.fontTextureStale = false;
+    if (context.dynamicAtlas) {
+        IM_DELETE(context.dynamicAtlas);
+        context.dynamicAtlas = NULL;
+    }
+    if (context.textureAtlas) {
+        IM_DELETE(context.textureAtlas);
+        context.textureAtlas = NULL;
+    }
+    if (context.inputQueue) {
+        IM_DELETE(context.inputQueue);
+        context.inputQueue = NULL;
+    }
+
+    for (int i = 0; i < ImGuiMouseCursor_COUNT; ++i) {
+        if (context.mouseCursors[i]) {
+            IM_DELETE(context.mouseCursors[i]);
+            context.mouseCursors[i] = NULL;
+
+            context.mouseCursorLoaded[i] = false;
+        }
+    }
+
+    context.textures.clear();
+    context.textureSlots.Clear();
+    context.freeTextureSlots.clear();
+
+    context.softwareTextures.clear();
+    context.softwareTriangles.clear();
+    context.softwarePixels.clear();
+    destroySoftwareWorkers(context);
+
+    destroySnapshot(context.drawDataCopy);
+    destroySnapshot(context.snapshots[0]);
+    destroySnapshot(context.snapshots[1]);
+    context.snapshotReady = context.snapshotRendered = -1;
+
+    if (context.renderCache) {
+        IM_DELETE(context.renderCache);
+        context.renderCache = NULL;
+        context.renderCacheValid = false;
+    }
+
+    // buffer objects and programs are shared between SFML's GL contexts, so
+    // any active context will do here
+    destroyShaderObjects(context);
+    destroyGPUTimer(context);
+    if (context.captureRecorder) {
+        IM_DELETE(context.captureRecorder);
+        context.captureRecorder = NULL;
+    }
+    if (context.vertexBuffer || context.indexBuffer) {
+        const GLFunctions& gl = getGLFunctions();
+        if (context.vertexBuffer) gl.deleteBuffers(1, &context.vertexBuffer);
+        if (context.indexBuffer) gl.deleteBuffers(1, &context.indexBuffer);
+        context.vertexBuffer = context.indexBuffer = 0;
+        context.vertexBufferCapacity = context.indexBufferCapacity = 0;
+        context.vertexBufferOffset = context.indexBufferOffset = 0;
+    }
+
+    // ImGui's context doesn't own a shared atlas, which may only go once
+    // the context is destroyed
+    ImGui::DestroyContext();
+    context.imguiContext = NULL;
+    ReleaseSharedFontAtlas(context.sharedFontAtlas);
+    context.sharedFontAtlas = NULL;
+    s_currentContext = NULL;
+}
+
+void InvalidateRenderCache(ImGuiSFMLContext& context) {
+    context.renderCacheValid = false;
+}
+
+int GetFrameProfileCount(ImGuiSFMLContext& context) {
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    return context.profilerHistoryCount;
+}
+
+ImGuiSFMLContext::FrameProfile GetFrameProfile(ImGuiSFMLContext& context, int age) {
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    if (age < 0 || age >= context.profilerHistoryCount) {
+        return ImGuiSFMLContext::FrameProfile();
+    }
+    int size = context.profilerHistory.Size;
+    return context.profilerHistory[(context.profilerHistoryNext - 1 - age + size) % size];
+}
+
+bool GetGPUTimings(ImGuiSFMLContext& context, ImGuiSFMLContext::GPUTimings& timings) {
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    timings = context.gpuTimings;
+    return timings.render != 0;
+}
+
+void ShowProfilerWindow(ImGuiSFMLContext& context, bool* open) {
+    if (!ImGui::Begin("ImGui-SFML profiler", open)) {
+        ImGui::End();
+        return;
+    }
+    if (!context.enableProfiler) {
+        ImGui::TextUnformatted("Set enableProfiler on the context to record frames.");
+        ImGui::End();
+        return;
+    }
+
+    // oldest first, copied so that the lock isn't held while ImGui draws
+    ImVector<FrameProfile> frames;
+    {
+        std::lock_guard<std::mutex> lock(context.snapshotMutex);
+        int size = context.profilerHistory.Size;
+        frames.resize(context.profilerHistoryCount);
+        for (int i = 0; i < frames.Size; ++i) {
+            frames[i] = context.profilerHistory[(context.profilerHistoryNext - frames.Size + i + size) % size];
+        }
+    }
+    if (frames.empty()) {
+        ImGui::TextUnformatted("No complete frame yet.");
+        ImGui::End();
+        return;
+    }
+
+    static const struct {
+        const char* name;
+        float FrameProfile::*phase;
+    } phases[] = {
+        {"ProcessEvent", &FrameProfile::processEventMs},
+        {"Mouse cursor", &FrameProfile::mouseCursorMs},
+        {"Input", &FrameProfile::inputMs},
+        {"Gamepad", &FrameProfile::gamepadMs},
+        {"NewFrame", &FrameProfile::newFrameMs},
+        {"ImGui::Render", &FrameProfile::imguiRenderMs},
+        {"GL submission", &FrameProfile::submitMs},
+        {"Font texture", &FrameProfile::fontTextureMs},
+    };
+    const int phaseCount = (int)(sizeof(phases) / sizeof(phases[0]));
+
+    ImVector<float> values;
+    values.resize(frames.Size);
+    for (int p = -1; p < phaseCount; ++p) {
+        // p == -1: all the phases
+        float sum = 0.f, maxValue = 0.f;
+        for (int i = 0; i < frames.Size; ++i) {
+            float value = 0.f;
+            if (p == -1) {
+                for (int q = 0; q < phaseCount; ++q) value += frames[i].*phases[q].phase;
+            } else {
+                value = frames[i].*phases[p].phase;
+            }
+            values[i] = value;
+            sum += value;
+            maxValue = ImMax(maxValue, value);
+        }
+        char overlay[64];
+        ImFormatString(overlay, IM_ARRAYSIZE(overlay), "last %.3f ms, avg %.3f, max %.3f",
+                       values.back(), sum / frames.Size, maxValue);
+        ImGui::PlotLines(p == -1 ? "Total" : phases[p].name, values.Data, values.Size, 0,
+                         overlay, 0.f, maxValue > 0.f ? maxValue : 1.f,
+                         ImVec2(0.f, p == -1 ? 60.f : 30.f));
+    }
+
+    const FrameProfile& last = frames.back();
+    ImGui::Separator();
+    ImGui::Text("Last frame: %u events, %u vertices, %u indices", last.events,
+                last.vertices, last.indices);
+    ImGui::Text("%u draw calls, %u texture binds, %u scissor changes", last.drawCalls,
+                last.textureBinds, last.scissorChanges);
+
+    if (context.gpuTiming) {
+        ImGuiSFMLContext::GPUTimings timings;
+        ImGui::Separator();
+        if (!GetGPUTimings(context, timings)) {
+            ImGui::TextUnformatted("GPU: no timing yet (timer queries may be unavailable).");
+        } else {
+            ImGui::Text("GPU: %.3f ms (render %u), %u renders skipped", timings.totalMs,
+                        timings.render, timings.skippedRenders);
+            for (int i = 0; i < timings.lists.Size; ++i) {
+                const char* owner = timings.lists[i].owner;
+                ImGui::BulletText("%s: %.3f ms", owner[0] ? owner : "(no window)",
+                                  timings.lists[i].ms);
+            }
+        }
+    }
+    ImGui::End();
+}
+
+void UpdateFontTexture(ImGuiSFMLContext& context) {
+    ProfileTimer timer(context, &FrameProfile::fontTextureMs);
+	ImGuiIO& io = context.imguiContext->IO;
+    unsigned char* pixels;
+    int width, height;
+
+    if (context.dynamicAtlas && !io.Fonts->Locked) {
+        reserveDynamicAtlasRegion(context);
+    }
+    if (!context.fontAtlasCachePath.empty() && !io.Fonts->IsBuilt() && !io.Fonts->Locked) {
+        buildFontAtlasWithCache(context);
+    }
+
+    if (context.sharedFontAtlas) {
+        UpdateSharedFontTexture(*context.sharedFontAtlas);
+        return;
+    }
+
+    if (context.alpha8FontAtlas) {
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+        if (uploadAlpha8FontTexture(context, pixels, width, height)) {
+            context.fontTextureStale = true;
+            io.Fonts->TexID = convertGLTextureHandleToImTextureID(context.fontAtlasTexture);
+            resetDynamicAtlas(context);
+            return;
+        }
+    }
+    destroyAlpha8FontTexture(context);
+    context.fontTextureStale = false;
+
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    sf::Texture& texture = *context.fontTexture;
+    texture.create(width, height);
+    texture.update(pixels);
+
+    io.Fonts->TexID =
+        convertGLTextureHandleToImTextureID(texture.getNativeHandle());
+    resetDynamicAtlas(context);
+}
+
+ImFont* AddDynamicFontFromFileTTF(ImGuiSFMLContext& context, const char* filename,
+                                  float sizePixels, const ImWchar* glyphRanges) {
+    if (context.sharedFontAtlas) {
+        // its glyphs would be rasterized into the atlas of every context
+        sf::err() << "ImGui-SFML: dynamic fonts can't be added to a shared font atlas" << std::endl;
+        return NULL;
+    }
+    setCurrentContext(context);
+    ImFontAtlas* atlas = context.imguiContext->IO.Fonts;
+
+    std::size_t dataSize = 0;
+    void* data = ImFileLoadToMemory(filename, "rb", &dataSize, 0);
+    if (!data) {
+        sf::err() << "ImGui-SFML: can't load font " << filename << std::endl;
+        return NULL;
+    }
+
+    DynamicAtlas::Font* font = IM_NEW(DynamicAtlas::Font);
+    const unsigned char* fontData = (const unsigned char*)data;
+    if (!stbtt_InitFont(&font->info, fontData, stbtt_GetFontOffsetForIndex(fontData, 0))) {
+        sf::err() << "ImGui-SFML: can't read font " << filename << std::endl;
+        IM_FREE(data);
+        IM_DELETE(font);
+        return NULL;
+    }
+
+    if (!context.dynamicAtlas) {
+        context.dynamicAtlas = IM_NEW(DynamicAtlas);
+    }
+    DynamicAtlas& dynamicAtlas = *context.dynamicAtlas;
+    int fontIndex = dynamicAtlas.fonts.Size;
+    dynamicAtlas.fonts.push_back(font);
+
+    ImFontConfig& config = font->config;
+    config.FontData = data;
+    config.FontDataSize = (int)dataSize;
+    config.FontDataOwnedByAtlas = false;
+    config.SizePixels = sizePixels;
+    config.GlyphRanges = glyphRanges ? glyphRanges : atlas->GetGlyphRangesDefault();
+    ImFormatString(config.Name, IM_ARRAYSIZE(config.Name), "%s, %.0fpx", filename, sizePixels);
+
+    // the same metrics as ImFontAtlasBuildSetupFont, without rasterizing anything
+    int unscaledAscent, unscaledDescent, lineGap;
+    stbtt_GetFontVMetrics(&font->info, &unscaledAscent, &unscaledDescent, &lineGap);
+    font->scale = stbtt_ScaleForPixelHeight(&font->info, sizePixels);
+    ImFont* imFont = font->font = IM_NEW(ImFont);
+    imFont->FontSize = sizePixels;
+    imFont->ConfigData = &config;
+    imFont->ConfigDataCount = 1;
+    imFont->ContainerAtlas = atlas;
+    imFont->Ascent = ImFloor(unscaledAscent * font->scale + (unscaledAscent > 0 ? +1 : -1));
+    imFont->Descent = ImFloor(unscaledDescent * font->scale + (unscaledDescent > 0 ? +1 : -1));
+    float offsetX = config.GlyphOffset.x;
+    float offsetY = config.GlyphOffset.y + (float)(int)(imFont->Ascent + 0.5f);
+
+    // ranges may overlap, and the lookup table is only built at the end
+    unsigned int maxCodepoint = 0;
+    for (const ImWchar* range = config.GlyphRanges; range[0] && range[1]; range += 2) {
+        maxCodepoint = std::max(maxCodepoint, (unsigned int)range[1]);
+    }
+    ImVector<unsigned char> added;
+    added.resize(maxCodepoint + 1);
+    memset(added.Data, 0, added.Size);
+
+    font->cellWidth = font->cellHeight = 1;
+    for (const ImWchar* range = config.GlyphRanges; range[0] && range[1]; range += 2) {
+        for (unsigned int codepoint = range[0]; codepoint <= range[1]; ++codepoint) {
+            if (added[codepoint]) {
+                continue;
+            }
+            added[codepoint] = 1;
+            int index = stbtt_FindGlyphIndex(&font->info, (int)codepoint);
+            if (index == 0) {
+                continue;
+            }
+
+            int advance, leftSideBearing, x0, y0, x1, y1;
+            stbtt_GetGlyphHMetrics(&font->info, index, &advance, &leftSideBearing);
+            stbtt_GetGlyphBitmapBox(&font->info, index, font->scale, font->scale, &x0, &y0,
+                                    &x1, &y1);
+
+            DynamicAtlas::Glyph glyph;
+            glyph.font = fontIndex;
+            glyph.index = index;
+            glyph.width = x1 - x0;
+            glyph.height = y1 - y0;
+            glyph.cell = -1;
+            font->cellWidth = std::max(font->cellWidth, glyph.width + 1);
+            font->cellHeight = std::max(font->cellHeight, glyph.height + 1);
+
+            float u0 = DYNAMIC_GLYPH_U + 2.0f * dynamicAtlas.glyphs.Size;
+            dynamicAtlas.glyphs.push_back(glyph);
+            imFont->AddGlyph((ImWchar)codepoint, x0 + offsetX, y0 + offsetY, x1 + offsetX,
+                             y1 + offsetY, u0, 0.0f, u0 + 1.0f, 1.0f, advance * font->scale);
+        }
+    }
+    imFont->BuildLookupTable();
+    return imFont;
+}
+
+ImTextureID GetTextureID(ImGuiSFMLContext& context, const sf::Texture& texture) {
+    return registerTexture(context, texture);
+}
+
+void UnregisterTexture(ImGuiSFMLContext& context, const sf::Texture& texture) {
+    if (context.textureAtlas) {
+        int entry = findAtlasEntry(*context.textureAtlas, texture);
+        if (entry != -1) {
+            removeAtlasEntry(*context.textureAtlas, entry);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    int index = findTextureSlot(context, texture);
+    if (index == -1) {
+        return;
+    }
+    ImGuiID key = textureSlotKey(texture);
+    if (context.textureSlots.GetInt(key) - 1 == index) {
+        context.textureSlots.SetInt(key, 0);
+    }
+    ImGuiSFMLContext::TextureRecord& record = context.textures[index];
+    record.texture = NULL;
+    record.glName = 0;
+    ++record.generation;  // the slot's next texture gets other IDs
+    context.freeTextureSlots.push_back(index);
+}
+
+sf::Texture& GetFontTexture(ImGuiSFMLContext& context) {
+    ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    if (context.fontTextureStale && fonts->TexPixelsAlpha8) {
+        // white texels with the atlas' alpha, like GetTexDataAsRGBA32 makes them,
+        // without keeping the RGBA32 pixels in the atlas
+        int width = fonts->TexWidth, height = fonts->TexHeight;
+        ImVector<sf::Uint8> pixels;
+        pixels.resize(width * height * 4);
+        for (int i = 0; i < width * height; ++i) {
+            pixels[i * 4 + 0] = pixels[i * 4 + 1] = pixels[i * 4 + 2] = 255;
+            pixels[i * 4 + 3] = fonts->TexPixelsAlpha8[i];
+        }
+        context.fontTexture->create(width, height);
+        context.fontTexture->update(pixels.Data);
+        context.fontTextureStale = false;
+    }
+    return *context.fontTexture;
+}
 
 void SetActiveJoystickId(ImGuiSFMLContext& context, unsigned int joystickId) {
     assert(joystickId < sf::Joystick::Count);
-    context.joystickId = joystickId;
+    setActiveJoystick(context, joystickId);
 }
 
 void SetJoytickDPadThreshold(ImGuiSFMLContext& context, float threshold) {
@@ -538,11 +1894,9 @@ void Image(const sf::Texture& texture, const sf::Color& tintColor,
 
 void Image(const sf::Texture& texture, const sf::Vector2f& size,
            const sf::Color& tintColor, const sf::Color& borderColor) {
-    ImTextureID textureID =
-        convertGLTextureHandleToImTextureID(texture.getNativeHandle());
-    
-    ImGui::Image(textureID, ImVec2(size.x,size.y), ImVec2(0, 0), ImVec2(1, 1), toImColor(tintColor),
-        toImColor(borderColor));
+    sf::Vector2f textureSize = static_cast<sf::Vector2f>(texture.getSize());
+    Image(texture, size, sf::FloatRect(0.f, 0.f, textureSize.x, textureSize.y),
+          tintColor, borderColor);
 }
 
 void Image(const sf::Texture& texture, const sf::FloatRect& textureRect,
@@ -556,14 +1910,8 @@ void Image(const sf::Texture& texture, const sf::FloatRect& textureRect,
 void Image(const sf::Texture& texture, const sf::Vector2f& size,
            const sf::FloatRect& textureRect, const sf::Color& tintColor,
            const sf::Color& borderColor) {
-    sf::Vector2f textureSize = static_cast<sf::Vector2f>(texture.getSize());
-    ImVec2 uv0(textureRect.left / textureSize.x,
-               textureRect.top / textureSize.y);
-    ImVec2 uv1((textureRect.left + textureRect.width) / textureSize.x,
-               (textureRect.top + textureRect.height) / textureSize.y);
-
-    ImTextureID textureID =
-        convertGLTextureHandleToImTextureID(texture.getNativeHandle());
+    ImVec2 uv0, uv1;
+    ImTextureID textureID = getTextureIDForCurrentContext(texture, textureRect, uv0, uv1);
     ImGui::Image(textureID, ImVec2(size.x, size.y), uv0, uv1, toImColor(tintColor),
         toImColor(borderColor));
 }
@@ -631,24 +1979,58 @@ void DrawLine(const sf::Vector2f& a, const sf::Vector2f& b,
               const sf::Color& color, float thickness) {
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
     ImVec2 pos = ImGui::GetCursorScreenPos();
-    draw_list->AddLine(ImVec2(a.x + pos.x, a.y + pos.y), ImVec2(b.x + pos.x, b.y + pos.y), ColorConvertFloat4ToU32(toImColor(color)),
+    draw_list->AddLine(ImVec2(a.x + pos.x, a.y + pos.y), ImVec2(b.x + pos.x, b.y + pos.y), toImU32(color),
                        thickness);
 }
 
 void DrawRect(const sf::FloatRect& rect, const sf::Color& color, float rounding,
               int rounding_corners, float thickness) {
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
-    draw_list->AddRect(getTopLeftAbsolute(rect), getDownRightAbsolute(rect),
-                       ColorConvertFloat4ToU32(toImColor(color)), rounding,
-                       rounding_corners, thickness);
+    ImVec2 topLeft = getTopLeftAbsolute(rect);
+    draw_list->AddRect(topLeft, ImVec2(topLeft.x + rect.width, topLeft.y + rect.height),
+                       toImU32(color), rounding, rounding_corners, thickness);
 }
 
 void DrawRectFilled(const sf::FloatRect& rect, const sf::Color& color,
                     float rounding, int rounding_corners) {
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
-    draw_list->AddRectFilled(
-        getTopLeftAbsolute(rect), getDownRightAbsolute(rect),
-        ColorConvertFloat4ToU32(toImColor(color)), rounding, rounding_corners);
+    ImVec2 topLeft = getTopLeftAbsolute(rect);
+    draw_list->AddRectFilled(topLeft, ImVec2(topLeft.x + rect.width, topLeft.y + rect.height),
+                             toImU32(color), rounding, rounding_corners);
+}
+
+void DrawVertexArray(const sf::VertexArray& vertices, const sf::Transform& transform) {
+    if (vertices.getVertexCount() == 0) {
+        return;
+    }
+    DrawVertexArray(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType(),
+                    transform);
+}
+
+void DrawVertexArray(const sf::Vertex* vertices, std::size_t vertexCount,
+                     sf::PrimitiveType type, const sf::Transform& transform) {
+    if (!vertices || vertexCount == 0) {
+        return;
+    }
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+
+    // 2D part of SFML's column-major 4x4 matrix, moved to the cursor
+    const float* m = transform.getMatrix();
+    const VertexTransform vertexTransform = {m[0], m[1], m[4], m[5], m[12] + pos.x,
+                                             m[13] + pos.y, ImGui::GetFontTexUvWhitePixel()};
+
+    int count = (int)std::min(vertexCount, (std::size_t)INT_MAX);
+    switch (type) {
+        case sf::Points:
+        case sf::Lines:
+        case sf::LineStrip:
+            drawVertexLines(draw_list, vertices, count, type, vertexTransform);
+            break;
+        default:
+            drawVertexTriangles(draw_list, vertices, count, type, vertexTransform);
+            break;
+    }
 }
 
 }  // end of namespace ImGui
@@ -657,6 +2039,170 @@ namespace {
 ImColor toImColor(sf::Color c ) {
     return ImColor(static_cast<int>(c.r), static_cast<int>(c.g), static_cast<int>(c.b), static_cast<int>(c.a));
 }
+ImU32 toImU32(sf::Color c) {
+    // without going through floats. With ImGui's default packing, this is
+    // sf::Color's memory layout and compiles to a single load.
+    return IM_COL32(c.r, c.g, c.b, c.a);
+}
+
+void writeVertices(ImDrawList* draw_list, const sf::Vertex* vertices, int count,
+                   const VertexTransform& transform) {
+    ImDrawVert* out = draw_list->_VtxWritePtr;
+    int i = 0;
+#ifdef IMGUI_SFML_SSE2
+    const __m128 xFactors = _mm_setr_ps(transform.a, transform.b, transform.a, transform.b);
+    const __m128 yFactors = _mm_setr_ps(transform.c, transform.d, transform.c, transform.d);
+    const __m128 offsets = _mm_setr_ps(transform.tx, transform.ty, transform.tx, transform.ty);
+    for (; i + 2 <= count; i += 2) {
+        // x0 y0 x1 y1
+        __m128 p = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&vertices[i].position);
+        p = _mm_loadh_pi(p, (const __m64*)&vertices[i + 1].position);
+        __m128 xs = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 ys = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, xFactors), _mm_mul_ps(ys, yFactors)),
+                              offsets);
+        _mm_storel_pi((__m64*)&out[i].pos, r);
+        _mm_storeh_pi((__m64*)&out[i + 1].pos, r);
+        out[i].uv = out[i + 1].uv = transform.uv;
+        out[i].col = toImU32(vertices[i].color);
+        out[i + 1].col = toImU32(vertices[i + 1].color);
+    }
+#endif
+    for (; i < count; ++i) {
+        const sf::Vector2f& p = vertices[i].position;
+        out[i].pos = ImVec2(transform.a * p.x + transform.c * p.y + transform.tx,
+                            transform.b * p.x + transform.d * p.y + transform.ty);
+        out[i].uv = transform.uv;
+        out[i].col = toImU32(vertices[i].color);
+    }
+    draw_list->_VtxWritePtr += count;
+}
+
+// vertices per PrimReserve: indices are 16-bit, and whole triangles and quads fit
+const int VERTEX_ARRAY_CHUNK = 65532;
+
+void drawVertexTriangles(ImDrawList* draw_list, const sf::Vertex* vertices, int count,
+                         sf::PrimitiveType type, const VertexTransform& transform) {
+    // strips and fans go on from the last two vertices (for fans, the first
+    // and the last one) of the previous chunk
+    int start = type == sf::TriangleFan ? 1 : 0;
+    while (true) {
+        int chunk = std::min(VERTEX_ARRAY_CHUNK - 1, count - start);
+        int triangles;
+        switch (type) {
+            case sf::Triangles:
+                chunk -= chunk % 3;
+                triangles = chunk / 3;
+                break;
+            case sf::Quads:
+                chunk -= chunk % 4;
+                triangles = chunk / 2;
+                break;
+            case sf::TriangleFan:
+                triangles = chunk - 1;
+                break;
+            default:  // sf::TriangleStrip
+                triangles = chunk - 2;
+                break;
+        }
+        if (triangles <= 0) {
+            return;
+        }
+
+        bool fan = type == sf::TriangleFan;
+        draw_list->PrimReserve(triangles * 3, chunk + (fan ? 1 : 0));
+        ImDrawIdx base = (ImDrawIdx)draw_list->_VtxCurrentIdx;
+        if (fan) {
+            writeVertices(draw_list, vertices, 1, transform);
+        }
+        writeVertices(draw_list, vertices + start, chunk, transform);
+
+        ImDrawIdx* idx = draw_list->_IdxWritePtr;
+        switch (type) {
+            case sf::Triangles:
+                for (int i = 0; i < chunk; ++i) idx[i] = (ImDrawIdx)(base + i);
+                break;
+            case sf::Quads:
+                for (int q = 0; q < chunk / 4; ++q, idx += 6) {
+                    ImDrawIdx v = (ImDrawIdx)(base + q * 4);
+                    idx[0] = v; idx[1] = (ImDrawIdx)(v + 1); idx[2] = (ImDrawIdx)(v + 2);
+                    idx[3] = v; idx[4] = (ImDrawIdx)(v + 2); idx[5] = (ImDrawIdx)(v + 3);
+                }
+                break;
+            case sf::TriangleFan:
+                for (int t = 0; t < triangles; ++t, idx += 3) {
+                    idx[0] = base;
+                    idx[1] = (ImDrawIdx)(base + 1 + t);
+                    idx[2] = (ImDrawIdx)(base + 2 + t);
+                }
+                break;
+            default:
+                for (int t = 0; t < triangles; ++t, idx += 3) {
+                    idx[0] = (ImDrawIdx)(base + t);
+                    idx[1] = (ImDrawIdx)(base + t + 1);
+                    idx[2] = (ImDrawIdx)(base + t + 2);
+                }
+                break;
+        }
+        draw_list->_IdxWritePtr += triangles * 3;
+        draw_list->_VtxCurrentIdx += chunk + (fan ? 1 : 0);
+
+        if (type == sf::Triangles || type == sf::Quads) {
+            start += chunk;
+        } else {
+            start += chunk - (fan ? 1 : 2);
+        }
+    }
+}
+
+void drawVertexLines(ImDrawList* draw_list, const sf::Vertex* vertices, int count,
+                     sf::PrimitiveType type, const VertexTransform& transform) {
+    // a quad per point or segment, each one written as it's transformed
+    int primitives = type == sf::Points ? count : (type == sf::Lines ? count / 2 : count - 1);
+    const int perChunk = VERTEX_ARRAY_CHUNK / 4;
+    for (int first = 0; first < primitives; first += perChunk) {
+        int chunk = std::min(perChunk, primitives - first);
+        draw_list->PrimReserve(chunk * 6, chunk * 4);
+        ImDrawVert* out = draw_list->_VtxWritePtr;
+        ImDrawIdx* idx = draw_list->_IdxWritePtr;
+        ImDrawIdx base = (ImDrawIdx)draw_list->_VtxCurrentIdx;
+
+        for (int i = 0; i < chunk; ++i, out += 4, idx += 6) {
+            int p = first + i;
+            const sf::Vertex& va = vertices[type == sf::Lines ? p * 2 : p];
+            const sf::Vertex& vb = type == sf::Points ? va : vertices[type == sf::Lines ? p * 2 + 1 : p + 1];
+            ImVec2 a(transform.a * va.position.x + transform.c * va.position.y + transform.tx,
+                     transform.b * va.position.x + transform.d * va.position.y + transform.ty);
+            ImVec2 b(transform.a * vb.position.x + transform.c * vb.position.y + transform.tx,
+                     transform.b * vb.position.x + transform.d * vb.position.y + transform.ty);
+
+            // half a pixel on each side of the segment, or around the point
+            ImVec2 n(0.f, 0.5f), t(0.5f, 0.f);
+            if (type != sf::Points) {
+                float dx = b.x - a.x, dy = b.y - a.y;
+                float length = std::sqrt(dx * dx + dy * dy);
+                float inv = length > 0.f ? 0.5f / length : 0.f;
+                n = ImVec2(-dy * inv, dx * inv);
+                t = ImVec2(0.f, 0.f);
+            }
+            ImU32 colA = toImU32(va.color), colB = toImU32(vb.color);
+            out[0].pos = ImVec2(a.x + n.x - t.x, a.y + n.y - t.y);
+            out[1].pos = ImVec2(b.x + n.x + t.x, b.y + n.y + t.y);
+            out[2].pos = ImVec2(b.x - n.x + t.x, b.y - n.y + t.y);
+            out[3].pos = ImVec2(a.x - n.x - t.x, a.y - n.y - t.y);
+            out[0].col = out[3].col = colA;
+            out[1].col = out[2].col = colB;
+            out[0].uv = out[1].uv = out[2].uv = out[3].uv = transform.uv;
+
+            ImDrawIdx v = (ImDrawIdx)(base + i * 4);
+            idx[0] = v; idx[1] = (ImDrawIdx)(v + 1); idx[2] = (ImDrawIdx)(v + 2);
+            idx[3] = v; idx[4] = (ImDrawIdx)(v + 2); idx[5] = (ImDrawIdx)(v + 3);
+        }
+        draw_list->_VtxWritePtr = out;
+        draw_list->_IdxWritePtr = idx;
+        draw_list->_VtxCurrentIdx += chunk * 4;
+    }
+}
 ImVec2 getTopLeftAbsolute(const sf::FloatRect& rect) {
     ImVec2 pos = ImGui::GetCursorScreenPos();
     return ImVec2(rect.left + pos.x, rect.top + pos.y);
@@ -668,232 +2214,3681 @@ ImVec2 getDownRightAbsolute(const sf::FloatRect& rect) {
 }
 
 ImTextureID convertGLTextureHandleToImTextureID(GLuint glTextureHandle) {
-    ImTextureID textureID = (ImTextureID)NULL;
-    std::memcpy(&textureID, &glTextureHandle, sizeof(GLuint));
-    return textureID;
+    return (ImTextureID)(std::size_t)glTextureHandle;
 }
 GLuint convertImTextureIDToGLTextureHandle(ImTextureID textureID) {
-    GLuint glTextureHandle;
-    std::memcpy(&glTextureHandle, &textureID, sizeof(GLuint));
-    return glTextureHandle;
+    return (GLuint)(std::size_t)textureID;
 }
 
-// Rendering callback
-void RenderDrawLists(ImDrawData* draw_data) {
-    ImGui::GetDrawData();
-    if (draw_data->CmdListsCount == 0) {
-        return;
-    }
+const std::size_t TEXTURE_ID_TAG = (std::size_t)1 << (sizeof(std::size_t) * 8 - 1);
+const int TEXTURE_INDEX_BITS = 20;
+const unsigned int TEXTURE_GENERATION_MASK = 0x7FF;
 
-    ImGuiIO& io = ImGui::GetIO();
-    assert(io.Fonts->TexID !=
-           (ImTextureID)NULL);  // You forgot to create and set font texture
+ImTextureID makeTextureID(int index, unsigned int generation) {
+    return (ImTextureID)(TEXTURE_ID_TAG |
+                         ((std::size_t)(generation & TEXTURE_GENERATION_MASK) << TEXTURE_INDEX_BITS) |
+                         (std::size_t)index);
+}
 
-    // scale stuff (needed for proper handling of window resize)
-    int fb_width =
-        static_cast<int>(io.DisplaySize.x * io.DisplayFramebufferScale.x);
-    int fb_height =
-        static_cast<int>(io.DisplaySize.y * io.DisplayFramebufferScale.y);
-    if (fb_width == 0 || fb_height == 0) {
-        return;
+ImGuiID textureSlotKey(const sf::Texture& texture) {
+    const sf::Texture* address = &texture;
+    return ImHashData(&address, sizeof(address));
+}
+
+int findTextureSlot(const ImGui::SFML::ImGuiSFMLContext& context, const sf::Texture& texture) {
+    int index = context.textureSlots.GetInt(textureSlotKey(texture)) - 1;
+    if (index >= 0 && index < context.textures.Size && context.textures[index].texture == &texture) {
+        return index;
+    }
+    // two addresses with the same hash: the second one isn't in textureSlots
+    for (int i = 0; i < context.textures.Size; ++i) {
+        if (context.textures[i].texture == &texture) return i;
     }
-    draw_data->ScaleClipRects(io.DisplayFramebufferScale);
+    return -1;
+}
 
-#ifdef GL_VERSION_ES_CL_1_1
-    GLint last_program, last_texture, last_array_buffer,
-        last_element_array_buffer;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-#else
-    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TRANSFORM_BIT);
-#endif
+ImTextureID registerTexture(ImGui::SFML::ImGuiSFMLContext& context, const sf::Texture& texture) {
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    int index = findTextureSlot(context, texture);
+    if (index == -1) {
+        if (!context.freeTextureSlots.empty()) {
+            index = context.freeTextureSlots.back();
+            context.freeTextureSlots.pop_back();
+        } else {
+            index = context.textures.Size;
+            if (index >= (1 << TEXTURE_INDEX_BITS)) {
+                return convertGLTextureHandleToImTextureID(texture.getNativeHandle());
+            }
+            context.textures.push_back(ImGui::SFML::ImGuiSFMLContext::TextureRecord());
+        }
+        ImGuiID key = textureSlotKey(texture);
+        int previous = context.textureSlots.GetInt(key) - 1;
+        if (previous < 0 || context.textures[previous].texture == NULL) {
+            context.textureSlots.SetInt(key, index + 1);
+        }
+        context.textures[index].texture = &texture;
+        context.textures[index].glName = 0;
+    }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_SCISSOR_TEST);
-    glEnable(GL_TEXTURE_2D);
-    glDisable(GL_LIGHTING);
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glEnableClientState(GL_COLOR_ARRAY);
-    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    // a new GL name means the texture was re-created (or destroyed and another one
+    // took its address): IDs handed out before don't draw it
+    ImGui::SFML::ImGuiSFMLContext::TextureRecord& record = context.textures[index];
+    if (record.glName != texture.getNativeHandle()) {
+        if (record.glName != 0) {
+            ++record.generation;
+        }
+        record.glName = texture.getNativeHandle();
+    }
+    record.size = texture.getSize();
+    record.smooth = texture.isSmooth();
+    record.repeated = texture.isRepeated();
+    return makeTextureID(index, record.generation);
+}
 
-    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+bool resolveTextureID(ImGui::SFML::ImGuiSFMLContext& context, ImTextureID textureID,
+                      GLuint& glTextureHandle) {
+    std::size_t id = (std::size_t)textureID;
+    if ((id & TEXTURE_ID_TAG) == 0) {
+        glTextureHandle = convertImTextureIDToGLTextureHandle(textureID);
+        return true;
+    }
 
-    glMatrixMode(GL_TEXTURE);
-    glLoadIdentity();
+    int index = (int)(id & ((1 << TEXTURE_INDEX_BITS) - 1));
+    unsigned int generation = (unsigned int)(id >> TEXTURE_INDEX_BITS) & TEXTURE_GENERATION_MASK;
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    if (index >= context.textures.Size || !context.textures[index].texture ||
+        (context.textures[index].generation & TEXTURE_GENERATION_MASK) != generation) {
+        return false;
+    }
+    glTextureHandle = context.textures[index].glName;
+    return true;
+}
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
+bool getRegisteredTextureSize(ImGui::SFML::ImGuiSFMLContext& context, ImTextureID textureID,
+                              sf::Vector2u& size) {
+    std::size_t id = (std::size_t)textureID;
+    if ((id & TEXTURE_ID_TAG) == 0) {
+        return false;
+    }
 
-#ifdef GL_VERSION_ES_CL_1_1
-    glOrthof(0.0f, io.DisplaySize.x, io.DisplaySize.y, 0.0f, -1.0f, +1.0f);
-#else
-    glOrtho(0.0f, io.DisplaySize.x, io.DisplaySize.y, 0.0f, -1.0f, +1.0f);
-#endif
+    int index = (int)(id & ((1 << TEXTURE_INDEX_BITS) - 1));
+    unsigned int generation = (unsigned int)(id >> TEXTURE_INDEX_BITS) & TEXTURE_GENERATION_MASK;
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    if (index >= context.textures.Size || !context.textures[index].texture ||
+        (context.textures[index].generation & TEXTURE_GENERATION_MASK) != generation) {
+        return false;
+    }
+    size = context.textures[index].size;
+    return true;
+}
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+ImTextureID getTextureIDForCurrentContext(const sf::Texture& texture,
+                                          const sf::FloatRect& textureRect,
+                                          ImVec2& uv0, ImVec2& uv1) {
+    sf::Vector2f textureSize = static_cast<sf::Vector2f>(texture.getSize());
+    uv0 = ImVec2(textureRect.left / textureSize.x,
+                 textureRect.top / textureSize.y);
+    uv1 = ImVec2((textureRect.left + textureRect.width) / textureSize.x,
+                 (textureRect.top + textureRect.height) / textureSize.y);
+
+    ImGui::SFML::ImGuiSFMLContext* context =
+        static_cast<ImGui::SFML::ImGuiSFMLContext*>(ImGui::GetIO().BackendPlatformUserData);
+    if (!context) {
+        return convertGLTextureHandleToImTextureID(texture.getNativeHandle());
+    }
+    ImTextureID textureID;
+    if (context->atlasSmallTextures && atlasTexture(*context, texture, uv0, uv1, textureID)) {
+        return textureID;
+    }
+    return registerTexture(*context, texture);
+}
+
+int findAtlasEntry(const TextureAtlas& atlas, const sf::Texture& texture) {
+    int index = atlas.entrySlots.GetInt(textureSlotKey(texture)) - 1;
+    if (index >= 0 && atlas.entries[index].texture == &texture) {
+        return index;
+    }
+    // two addresses with the same hash: the second one isn't in entrySlots
+    for (int i = 0; i < atlas.entries.Size; ++i) {
+        if (atlas.entries[i].texture == &texture) return i;
+    }
+    return -1;
+}
+
+void removeAtlasEntry(TextureAtlas& atlas, int index) {
+    TextureAtlas::Entry& entry = atlas.entries[index];
+    ImGuiID key = textureSlotKey(*entry.texture);
+    if (atlas.entrySlots.GetInt(key) - 1 == index) {
+        atlas.entrySlots.SetInt(key, 0);
+    }
+    entry.texture = NULL;
+    atlas.freeEntries.push_back(index);
+}
+
+void freeAtlasPage(ImGui::SFML::ImGuiSFMLContext& context, int index) {
+    TextureAtlas& atlas = *context.textureAtlas;
+    TextureAtlas::Page& page = atlas.pages[index];
+    for (int i = 0; i < atlas.entries.Size; ++i) {
+        if (atlas.entries[i].texture && atlas.entries[i].page == index) {
+            removeAtlasEntry(atlas, i);
+        }
+    }
+    // IDs of the page in draw data which is still to be rendered won't draw it
+    ImGui::SFML::UnregisterTexture(context, page.texture->getTexture());
+    IM_DELETE(page.texture);
+    page.texture = NULL;
+}
+
+bool evictAtlasPages(ImGui::SFML::ImGuiSFMLContext& context, bool force) {
+    TextureAtlas& atlas = *context.textureAtlas;
+    int frame = ImGui::GetFrameCount();
+    bool evicted = false;
+    for (int i = 0; i < atlas.pages.Size; ++i) {
+        if (atlas.pages[i].texture && frame - atlas.pages[i].lastUsedFrame > context.atlasEvictFrames) {
+            freeAtlasPage(context, i);
+            evicted = true;
+        }
+    }
+    if (evicted || !force) {
+        return evicted;
+    }
+
+    // pages drawn by this frame are in use
+    int oldest = -1;
+    for (int i = 0; i < atlas.pages.Size; ++i) {
+        const TextureAtlas::Page& page = atlas.pages[i];
+        if (page.texture && page.lastUsedFrame != frame &&
+            (oldest == -1 || page.lastUsedFrame < atlas.pages[oldest].lastUsedFrame)) {
+            oldest = i;
+        }
+    }
+    if (oldest == -1) {
+        return false;
+    }
+    freeAtlasPage(context, oldest);
+    return true;
+}
+
+bool atlasTexture(ImGui::SFML::ImGuiSFMLContext& context, const sf::Texture& texture,
+                  ImVec2& uv0, ImVec2& uv1, ImTextureID& textureID) {
+    sf::Vector2u size = texture.getSize();
+    unsigned int pageSize = context.atlasPageSize;
+    if (size.x == 0 || size.y == 0 || size.x > context.smallTextureMaxSize ||
+        size.y > context.smallTextureMaxSize || size.x + 2 > pageSize ||
+        size.y + 2 > pageSize || texture.isRepeated()) {
+        return false;
+    }
+    // the other texels of the page would show outside of the texture
+    if (ImMin(uv0.x, uv1.x) < 0.f || ImMax(uv0.x, uv1.x) > 1.f ||
+        ImMin(uv0.y, uv1.y) < 0.f || ImMax(uv0.y, uv1.y) > 1.f) {
+        return false;
+    }
+
+    if (!context.textureAtlas) {
+        context.textureAtlas = IM_NEW(TextureAtlas);
+    }
+    TextureAtlas& atlas = *context.textureAtlas;
+    int frame = ImGui::GetFrameCount();
+
+    int index = findAtlasEntry(atlas, texture);
+    if (index != -1) {
+        const TextureAtlas::Entry& entry = atlas.entries[index];
+        // re-created or resized since it was copied, or smoothed/unsmoothed
+        if (entry.glName != texture.getNativeHandle() || entry.size != size ||
+            atlas.pages[entry.page].smooth != texture.isSmooth()) {
+            removeAtlasEntry(atlas, index);
+            index = -1;
+        }
+    }
+
+    if (index == -1) {
+        // a shelf of a page with the same filtering, or a new page
+        int w = (int)size.x + 2, h = (int)size.y + 2;  // 1 pixel of padding on each side
+        int pageIndex = -1, x = 0, y = 0;
+        for (int attempt = 0; attempt < 2 && pageIndex == -1; ++attempt) {
+            int freeSlot = -1, livePages = 0;
+            for (int i = 0; i < atlas.pages.Size && pageIndex == -1; ++i) {
+                TextureAtlas::Page& page = atlas.pages[i];
+                if (!page.texture) {
+                    if (freeSlot == -1) freeSlot = i;
+                    continue;
+                }
+                ++livePages;
+                if (page.smooth != texture.isSmooth()) continue;
+                int shelfX = page.shelfX, shelfY = page.shelfY, shelfHeight = page.shelfHeight;
+                if (shelfX + w > (int)pageSize) {
+                    shelfY += shelfHeight;
+                    shelfX = 0;
+                    shelfHeight = 0;
+                }
+                if (shelfY + h > (int)pageSize) continue;
+                page.shelfX = shelfX + w;
+                page.shelfY = shelfY;
+                page.shelfHeight = ImMax(shelfHeight, h);
+                pageIndex = i;
+                x = shelfX;
+                y = shelfY;
+            }
+            if (pageIndex != -1) break;
+
+            if (livePages < context.maxAtlasPages) {
+                sf::RenderTexture* renderTexture = IM_NEW(sf::RenderTexture);
+                if (!renderTexture->create(pageSize, pageSize)) {
+                    IM_DELETE(renderTexture);
+                    return false;
+                }
+                renderTexture->setSmooth(texture.isSmooth());
+                renderTexture->clear(sf::Color::Transparent);
+                if (freeSlot == -1) {
+                    freeSlot = atlas.pages.Size;
+                    atlas.pages.push_back(TextureAtlas::Page());
+                }
+                TextureAtlas::Page& page = atlas.pages[freeSlot];
+                page.texture = renderTexture;
+                page.smooth = texture.isSmooth();
+                page.shelfX = w;
+                page.shelfY = 0;
+                page.shelfHeight = h;
+                page.lastUsedFrame = frame;
+                pageIndex = freeSlot;
+                x = 0;
+                y = 0;
+            } else if (attempt > 0 || !evictAtlasPages(context, true)) {
+                return false;  // every page is used by this frame
+            }
+        }
+
+        if (!atlas.freeEntries.empty()) {
+            index = atlas.freeEntries.back();
+            atlas.freeEntries.pop_back();
+        } else {
+            index = atlas.entries.Size;
+            atlas.entries.push_back(TextureAtlas::Entry());
+        }
+        ImGuiID key = textureSlotKey(texture);
+        int previous = atlas.entrySlots.GetInt(key) - 1;
+        if (previous < 0 || atlas.entries[previous].texture == NULL) {
+            atlas.entrySlots.SetInt(key, index + 1);
+        }
+        TextureAtlas::Entry& entry = atlas.entries[index];
+        entry.texture = &texture;
+        entry.glName = texture.getNativeHandle();
+        entry.size = size;
+        entry.page = pageIndex;
+        entry.x = x + 1;
+        entry.y = y + 1;
+
+        // copied by the GPU, replacing the (transparent) texels of the page.
+        // The edge texels are repeated into the padding, so that smooth pages
+        // are filtered like the texture alone (clamped to its edges).
+        // source spans of the 3x3 cells: the first texel, the whole texture, the last texel
+        float width = (float)size.x, height = (float)size.y;
+        float srcX[3][2] = {{0.f, 1.f}, {0.f, width}, {width - 1.f, width}};
+        float srcY[3][2] = {{0.f, 1.f}, {0.f, height}, {height - 1.f, height}};
+        float dstX[4] = {(float)x, x + 1.f, x + 1.f + width, x + 2.f + width};
+        float dstY[4] = {(float)y, y + 1.f, y + 1.f + height, y + 2.f + height};
+        sf::Vertex quads[9 * 4];
+        int vertexCount = 0;
+        for (int row = 0; row < 3; ++row) {
+            for (int column = 0; column < 3; ++column) {
+                float sx0 = srcX[column][0], sx1 = srcX[column][1];
+                float sy0 = srcY[row][0], sy1 = srcY[row][1];
+                float dx0 = dstX[column], dx1 = dstX[column + 1];
+                float dy0 = dstY[row], dy1 = dstY[row + 1];
+                quads[vertexCount++] = sf::Vertex(sf::Vector2f(dx0, dy0), sf::Vector2f(sx0, sy0));
+                quads[vertexCount++] = sf::Vertex(sf::Vector2f(dx1, dy0), sf::Vector2f(sx1, sy0));
+                quads[vertexCount++] = sf::Vertex(sf::Vector2f(dx1, dy1), sf::Vector2f(sx1, sy1));
+                quads[vertexCount++] = sf::Vertex(sf::Vector2f(dx0, dy1), sf::Vector2f(sx0, sy1));
+            }
+        }
+        sf::RenderStates states(&texture);
+        states.blendMode = sf::BlendNone;
+        sf::RenderTexture& pageTexture = *atlas.pages[pageIndex].texture;
+        pageTexture.draw(quads, vertexCount, sf::Quads, states);
+        pageTexture.display();
+    }
+
+    const TextureAtlas::Entry& entry = atlas.entries[index];
+    TextureAtlas::Page& page = atlas.pages[entry.page];
+    page.lastUsedFrame = frame;
+
+    // the rows of a render texture are stored bottom to top, and ImGui's
+    // renderer doesn't flip them like sf::Sprite does
+    float scale = 1.f / (float)pageSize;
+    uv0 = ImVec2((entry.x + uv0.x * size.x) * scale, 1.f - (entry.y + uv0.y * size.y) * scale);
+    uv1 = ImVec2((entry.x + uv1.x * size.x) * scale, 1.f - (entry.y + uv1.y * size.y) * scale);
+    textureID = registerTexture(context, page.texture->getTexture());
+    return true;
+}
+
+const GLFunctions& getGLFunctions() {
+    static GLFunctions gl;
+    static std::once_flag loaded;  // contexts may render on several threads
+    std::call_once(loaded, [] { loadGLFunctions(gl); });
+    return gl;
+}
+
+void loadGLFunctions(GLFunctions& gl) {
+    // GL_VERSION is "major.minor ..." on desktop and "OpenGL ES major.minor ..." on GLES
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    if (version) {
+        const char* esPrefix = "OpenGL ES";
+        gl.isES = std::strncmp(version, esPrefix, std::strlen(esPrefix)) == 0;
+        while (*version && (*version < '0' || *version > '9')) {
+            ++version;
+        }
+        gl.majorVersion = std::atoi(version);
+        const char* minor = std::strchr(version, '.');
+        gl.minorVersion = minor ? std::atoi(minor + 1) : 0;
+    }
+
+    gl.genBuffers = (PFN_glGenBuffers)sf::Context::getFunction("glGenBuffers");
+    gl.deleteBuffers = (PFN_glDeleteBuffers)sf::Context::getFunction("glDeleteBuffers");
+    gl.bindBuffer = (PFN_glBindBuffer)sf::Context::getFunction("glBindBuffer");
+    gl.bufferData = (PFN_glBufferData)sf::Context::getFunction("glBufferData");
+    gl.bufferSubData = (PFN_glBufferSubData)sf::Context::getFunction("glBufferSubData");
+    gl.mapBufferRange = (PFN_glMapBufferRange)sf::Context::getFunction("glMapBufferRange");
+    gl.unmapBuffer = (PFN_glUnmapBuffer)sf::Context::getFunction("glUnmapBuffer");
+    gl.blendFuncSeparate =
+        (PFN_glBlendFuncSeparate)sf::Context::getFunction("glBlendFuncSeparate");
+    gl.activeTexture = (PFN_glActiveTexture)sf::Context::getFunction("glActiveTexture");
+    gl.clientActiveTexture =
+        (PFN_glClientActiveTexture)sf::Context::getFunction("glClientActiveTexture");
+
+    gl.createShader = (PFN_glCreateShader)sf::Context::getFunction("glCreateShader");
+    gl.shaderSource = (PFN_glShaderSource)sf::Context::getFunction("glShaderSource");
+    gl.compileShader = (PFN_glCompileShader)sf::Context::getFunction("glCompileShader");
+    gl.getShaderiv = (PFN_glGetShaderiv)sf::Context::getFunction("glGetShaderiv");
+    gl.getShaderInfoLog =
+        (PFN_glGetShaderInfoLog)sf::Context::getFunction("glGetShaderInfoLog");
+    gl.deleteShader = (PFN_glDeleteShader)sf::Context::getFunction("glDeleteShader");
+    gl.createProgram = (PFN_glCreateProgram)sf::Context::getFunction("glCreateProgram");
+    gl.attachShader = (PFN_glAttachShader)sf::Context::getFunction("glAttachShader");
+    gl.linkProgram = (PFN_glLinkProgram)sf::Context::getFunction("glLinkProgram");
+    gl.getProgramiv = (PFN_glGetProgramiv)sf::Context::getFunction("glGetProgramiv");
+    gl.getProgramInfoLog =
+        (PFN_glGetProgramInfoLog)sf::Context::getFunction("glGetProgramInfoLog");
+    gl.deleteProgram = (PFN_glDeleteProgram)sf::Context::getFunction("glDeleteProgram");
+    gl.useProgram = (PFN_glUseProgram)sf::Context::getFunction("glUseProgram");
+    gl.getUniformLocation =
+        (PFN_glGetUniformLocation)sf::Context::getFunction("glGetUniformLocation");
+    gl.getAttribLocation =
+        (PFN_glGetAttribLocation)sf::Context::getFunction("glGetAttribLocation");
+    gl.uniform1i = (PFN_glUniform1i)sf::Context::getFunction("glUniform1i");
+    gl.uniformMatrix4fv =
+        (PFN_glUniformMatrix4fv)sf::Context::getFunction("glUniformMatrix4fv");
+    gl.enableVertexAttribArray = (PFN_glEnableVertexAttribArray)sf::Context::getFunction(
+        "glEnableVertexAttribArray");
+    gl.vertexAttribPointer =
+        (PFN_glVertexAttribPointer)sf::Context::getFunction("glVertexAttribPointer");
+    gl.genVertexArrays =
+        (PFN_glGenVertexArrays)sf::Context::getFunction("glGenVertexArrays");
+    gl.deleteVertexArrays =
+        (PFN_glDeleteVertexArrays)sf::Context::getFunction("glDeleteVertexArrays");
+    gl.bindVertexArray =
+        (PFN_glBindVertexArray)sf::Context::getFunction("glBindVertexArray");
+
+    // buffer objects are core since GL 1.5 and GLES 1.1
+    bool buffersInCore = gl.isES ? (gl.majorVersion >= 2 ||
+                                    (gl.majorVersion == 1 && gl.minorVersion >= 1))
+                                 : (gl.majorVersion >= 2 ||
+                                    (gl.majorVersion == 1 && gl.minorVersion >= 5));
+    gl.hasBufferObjects =
+        (buffersInCore || sf::Context::isExtensionAvailable("GL_ARB_vertex_buffer_object")) &&
+        gl.genBuffers && gl.deleteBuffers && gl.bindBuffer && gl.bufferData &&
+        gl.bufferSubData;
+
+    // glMapBufferRange is core since GL 3.0 and GLES 3.0
+    gl.hasMapBufferRange =
+        (gl.majorVersion >= 3 ||
+         sf::Context::isExtensionAvailable("GL_ARB_map_buffer_range") ||
+         sf::Context::isExtensionAvailable("GL_EXT_map_buffer_range")) &&
+        gl.mapBufferRange && gl.unmapBuffer;
+
+    // glBlendFuncSeparate is GL 1.4, multitexturing GL 1.3
+    gl.hasMultitexture = (gl.isES || gl.majorVersion >= 2 ||
+                          (gl.majorVersion == 1 && gl.minorVersion >= 4)) &&
+                         gl.activeTexture && gl.clientActiveTexture &&
+                         gl.blendFuncSeparate;
+
+    // texture swizzles are core since GL 3.3 and GLES 3.0
+    gl.hasTextureSwizzle =
+        (gl.isES ? gl.majorVersion >= 3
+                 : (gl.majorVersion > 3 || (gl.majorVersion == 3 && gl.minorVersion >= 3))) ||
+        sf::Context::isExtensionAvailable("GL_ARB_texture_swizzle") ||
+        sf::Context::isExtensionAvailable("GL_EXT_texture_swizzle");
+
+    // GLSL 1.30 / GLSL ES 3.00 and vertex array objects: GL 3.0 and GLES 3.0
+    gl.hasShaders =
+        gl.majorVersion >= 3 && gl.hasBufferObjects && gl.blendFuncSeparate &&
+        gl.createShader && gl.shaderSource && gl.compileShader && gl.getShaderiv &&
+        gl.getShaderInfoLog && gl.deleteShader && gl.createProgram &&
+        gl.attachShader && gl.linkProgram && gl.getProgramiv &&
+        gl.getProgramInfoLog && gl.deleteProgram && gl.useProgram &&
+        gl.getUniformLocation && gl.getAttribLocation && gl.uniform1i &&
+        gl.uniformMatrix4fv && gl.enableVertexAttribArray &&
+        gl.vertexAttribPointer && gl.genVertexArrays && gl.deleteVertexArrays &&
+        gl.bindVertexArray;
+
+    // timestamp queries are core since GL 3.3, GLES only has them through
+    // GL_EXT_disjoint_timer_query, whose entry points have the EXT suffix
+    bool timerQueryInCore =
+        !gl.isES && (gl.majorVersion > 3 || (gl.majorVersion == 3 && gl.minorVersion >= 3));
+    bool arbTimerQuery =
+        timerQueryInCore || sf::Context::isExtensionAvailable("GL_ARB_timer_query");
+    gl.timerQueryDisjoint =
+        !arbTimerQuery && sf::Context::isExtensionAvailable("GL_EXT_disjoint_timer_query");
+    if (arbTimerQuery || gl.timerQueryDisjoint) {
+        bool ext = gl.timerQueryDisjoint;
+        gl.genQueries = (PFN_glGenQueries)sf::Context::getFunction(
+            ext ? "glGenQueriesEXT" : "glGenQueries");
+        gl.deleteQueries = (PFN_glDeleteQueries)sf::Context::getFunction(
+            ext ? "glDeleteQueriesEXT" : "glDeleteQueries");
+        gl.queryCounter = (PFN_glQueryCounter)sf::Context::getFunction(
+            ext ? "glQueryCounterEXT" : "glQueryCounter");
+        gl.getQueryObjectuiv = (PFN_glGetQueryObjectuiv)sf::Context::getFunction(
+            ext ? "glGetQueryObjectuivEXT" : "glGetQueryObjectuiv");
+        gl.getQueryObjectui64v = (PFN_glGetQueryObjectui64v)sf::Context::getFunction(
+            ext ? "glGetQueryObjectui64vEXT" : "glGetQueryObjectui64v");
+    }
+    gl.hasTimerQuery = gl.genQueries && gl.deleteQueries && gl.queryCounter &&
+                       gl.getQueryObjectuiv && gl.getQueryObjectui64v;
+}
+
+// Shaders of Renderer_Shader. The #version line is prepended at runtime, as
+// it depends on the GL context (GLSL 1.30 / 1.50 core / GLSL ES 3.00).
+const char* vertexShaderSource =
+    "uniform mat4 ProjMtx;\n"
+    "in vec2 Position;\n"
+    "in vec2 UV;\n"
+    "in vec4 Color;\n"
+    "out vec2 Frag_UV;\n"
+    "out vec4 Frag_Color;\n"
+    "void main() {\n"
+    "    Frag_UV = UV;\n"
+    "    Frag_Color = Color;\n"
+    "    gl_Position = ProjMtx * vec4(Position.xy, 0.0, 1.0);\n"
+    "}\n";
+
+const char* fragmentShaderSource =
+    "uniform sampler2D Texture;\n"
+    "in vec2 Frag_UV;\n"
+    "in vec4 Frag_Color;\n"
+    "out vec4 Out_Color;\n"
+    "void main() {\n"
+    "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+    "}\n";
+
+GLuint compileShader(GLenum type, const char* source) {
+    const GLFunctions& gl = getGLFunctions();
+
+    const char* version = "#version 130\n";
+    if (gl.isES) {
+        version = "#version 300 es\nprecision mediump float;\n";
+    } else if (gl.majorVersion > 3 || (gl.majorVersion == 3 && gl.minorVersion >= 2)) {
+        version = "#version 150\n";  // core profiles might not accept 1.30
+    }
+    const char* sources[2] = {version, source};
+
+    GLuint shader = gl.createShader(type);
+    gl.shaderSource(shader, 2, sources, NULL);
+    gl.compileShader(shader);
+
+    GLint status = 0;
+    gl.getShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        GLint logLength = 0;
+        gl.getShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        std::string log(logLength > 0 ? logLength : 1, '\0');
+        gl.getShaderInfoLog(shader, static_cast<GLsizei>(log.size()), NULL, &log[0]);
+        sf::err() << "ImGui-SFML: failed to compile "
+                  << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                  << " shader:\n" << log.c_str() << std::endl;
+        gl.deleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool createShaderObjects(ImGui::SFML::ImGuiSFMLContext& context) {
+    const GLFunctions& gl = getGLFunctions();
+    if (!gl.hasShaders) {
+        sf::err() << "ImGui-SFML: the shader renderer needs OpenGL 3.0 or GLES 3.0, "
+                     "falling back to the fixed-function renderer" << std::endl;
+        return false;
+    }
+
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    if (!vertexShader || !fragmentShader) {
+        if (vertexShader) gl.deleteShader(vertexShader);
+        if (fragmentShader) gl.deleteShader(fragmentShader);
+        return false;
+    }
+
+    GLuint program = gl.createProgram();
+    gl.attachShader(program, vertexShader);
+    gl.attachShader(program, fragmentShader);
+    gl.linkProgram(program);
+    // the program keeps the shaders alive as long as it needs them
+    gl.deleteShader(vertexShader);
+    gl.deleteShader(fragmentShader);
+
+    GLint status = 0;
+    gl.getProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        GLint logLength = 0;
+        gl.getProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+        std::string log(logLength > 0 ? logLength : 1, '\0');
+        gl.getProgramInfoLog(program, static_cast<GLsizei>(log.size()), NULL, &log[0]);
+        sf::err() << "ImGui-SFML: failed to link shader program:\n" << log.c_str()
+                  << std::endl;
+        gl.deleteProgram(program);
+        return false;
+    }
+
+    ImGui::SFML::ImGuiSFMLContext::ShaderObjects& shader = context.shader;
+    shader.program = program;
+    shader.projectionLocation = gl.getUniformLocation(program, "ProjMtx");
+    shader.textureLocation = gl.getUniformLocation(program, "Texture");
+    shader.positionLocation = gl.getAttribLocation(program, "Position");
+    shader.uvLocation = gl.getAttribLocation(program, "UV");
+    shader.colorLocation = gl.getAttribLocation(program, "Color");
+    return true;
+}
+
+void destroyShaderObjects(ImGui::SFML::ImGuiSFMLContext& context) {
+    ImGui::SFML::ImGuiSFMLContext::ShaderObjects& shader = context.shader;
+    if (!shader.program && !shader.vertexArray) {
+        return;
+    }
+
+    const GLFunctions& gl = getGLFunctions();
+    if (shader.vertexArray) {
+        gl.deleteVertexArrays(1, &shader.vertexArray);
+    }
+    if (shader.program) {
+        gl.deleteProgram(shader.program);
+    }
+    shader = ImGui::SFML::ImGuiSFMLContext::ShaderObjects();
+}
+
+bool uploadAlpha8FontTexture(ImGui::SFML::ImGuiSFMLContext& context,
+                             const unsigned char* pixels, int width, int height) {
+    // sf::Texture brings its own GL context, raw GL calls need one too
+    sf::Context* tempContext = NULL;
+    if (!sf::Context::getActiveContext()) {
+        tempContext = IM_NEW(sf::Context);
+    }
+
+    const GLFunctions& gl = getGLFunctions();
+    bool useShader = context.renderer == ImGui::SFML::Renderer_Shader;
+    if (useShader && !gl.hasTextureSwizzle) {
+        if (tempContext) IM_DELETE(tempContext);
+        return false;  // GL_ALPHA isn't there in core profiles
+    }
+
+    GLint lastTexture, lastAlignment;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &lastAlignment);
+
+    if (!context.fontAtlasTexture) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        context.fontAtlasTexture = texture;
+    }
+    glBindTexture(GL_TEXTURE_2D, context.fontAtlasTexture);
+    // same sampling as a default sf::Texture
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (useShader) {
+        // (1, 1, 1, red), so the shader doesn't need to know about the format
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE,
+                     pixels);
+    } else {
+        // GL_MODULATE keeps the vertex color and multiplies its alpha, the same
+        // as the all-white texels of the RGBA32 atlas
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA,
+                     GL_UNSIGNED_BYTE, pixels);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, lastAlignment);
+    glBindTexture(GL_TEXTURE_2D, lastTexture);
+    if (tempContext) IM_DELETE(tempContext);
+    return true;
+}
+
+void destroyAlpha8FontTexture(ImGui::SFML::ImGuiSFMLContext& context) {
+    if (context.fontAtlasTexture) {
+        GLuint texture = context.fontAtlasTexture;
+        glDeleteTextures(1, &texture);
+        context.fontAtlasTexture = 0;
+    }
+}
+
+// Number of frames which fit into a streaming buffer before it has to be orphaned
+const std::size_t STREAMING_BUFFER_FRAMES = 3;
+
+// Reserves 'size' bytes in the ring buffer bound to 'target' and returns the
+// offset of the reserved range
+std::size_t reserveStreamingRange(GLenum target, unsigned int& buffer,
+                                  unsigned int& capacity, unsigned int& offset,
+                                  std::size_t size) {
+    const GLFunctions& gl = getGLFunctions();
+    if (buffer == 0) {
+        gl.genBuffers(1, &buffer);
+    }
+    gl.bindBuffer(target, buffer);
+
+    if (size > capacity) {
+        // grow, so that a few frames fit in before we have to wrap around again
+        capacity = static_cast<unsigned int>(size * STREAMING_BUFFER_FRAMES);
+        gl.bufferData(target, capacity, NULL, GL_STREAM_DRAW);
+        offset = 0;
+    } else if (offset + size > capacity) {
+        // orphan the storage instead of waiting for the GPU to finish reading
+        // the previous frames: the driver gives us a fresh block of memory
+        gl.bufferData(target, capacity, NULL, GL_STREAM_DRAW);
+        offset = 0;
+    }
+
+    std::size_t start = offset;
+    // keep each frame's data aligned, so that offsets are valid for any index type
+    offset = static_cast<unsigned int>((offset + size + 15) & ~std::size_t(15));
+    if (offset > capacity) {
+        offset = capacity;
+    }
+    return start;
+}
+
+template <typename T>
+void writeStreamingRange(GLenum target, std::size_t start, std::size_t size,
+                         const ImDrawData* draw_data,
+                         const ImVector<T> ImDrawList::*source) {
+    const GLFunctions& gl = getGLFunctions();
+    unsigned char* dst = NULL;
+    if (gl.hasMapBufferRange) {
+        // the range was never handed to the GPU since the last orphaning, so
+        // no synchronization is needed
+        dst = static_cast<unsigned char*>(gl.mapBufferRange(
+            target, start, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                GL_MAP_UNSYNCHRONIZED_BIT));
+    }
+
+    std::size_t offset = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const ImVector<T>& data = draw_data->CmdLists[n]->*source;
+        std::size_t bytes = data.Size * sizeof(T);
+        if (dst) {
+            std::memcpy(dst + offset, data.Data, bytes);
+        } else {
+            gl.bufferSubData(target, start + offset, bytes, data.Data);
+        }
+        offset += bytes;
+    }
+
+    if (dst) {
+        gl.unmapBuffer(target);
+    }
+}
+
+bool uploadDrawData(ImGui::SFML::ImGuiSFMLContext& context,
+                    const ImDrawData* draw_data, std::size_t& vtxStart,
+                    std::size_t& idxStart) {
+    if (!getGLFunctions().hasBufferObjects) {
+        return false;
+    }
+
+    std::size_t vtxSize = draw_data->TotalVtxCount * sizeof(ImDrawVert);
+    std::size_t idxSize = draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+
+    vtxStart = reserveStreamingRange(GL_ARRAY_BUFFER, context.vertexBuffer,
+                                     context.vertexBufferCapacity,
+                                     context.vertexBufferOffset, vtxSize);
+    writeStreamingRange(GL_ARRAY_BUFFER, vtxStart, vtxSize, draw_data,
+                        &ImDrawList::VtxBuffer);
+
+    idxStart = reserveStreamingRange(GL_ELEMENT_ARRAY_BUFFER, context.indexBuffer,
+                                     context.indexBufferCapacity,
+                                     context.indexBufferOffset, idxSize);
+    writeStreamingRange(GL_ELEMENT_ARRAY_BUFFER, idxStart, idxSize, draw_data,
+                        &ImDrawList::IdxBuffer);
+    return true;
+}
+
+// GL state which the shader renderer changes. glPushAttrib isn't available in
+// core profiles and GLES, so it's saved and restored by hand.
+struct ShaderStateBackup {
+    GLint program;
+    GLint texture;
+    GLint arrayBuffer;
+    GLint vertexArray;
+    GLint viewport[4];
+    GLint scissorBox[4];
+    GLint blendSrcRgb, blendDstRgb, blendSrcAlpha, blendDstAlpha;
+    GLboolean blend, cullFace, depthTest, scissorTest;
+};
+
+void saveShaderState(ShaderStateBackup& backup) {
+    glGetIntegerv(GL_CURRENT_PROGRAM, &backup.program);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &backup.texture);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &backup.arrayBuffer);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &backup.vertexArray);
+    glGetIntegerv(GL_VIEWPORT, backup.viewport);
+    glGetIntegerv(GL_SCISSOR_BOX, backup.scissorBox);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &backup.blendSrcRgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &backup.blendDstRgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &backup.blendSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &backup.blendDstAlpha);
+    backup.blend = glIsEnabled(GL_BLEND);
+    backup.cullFace = glIsEnabled(GL_CULL_FACE);
+    backup.depthTest = glIsEnabled(GL_DEPTH_TEST);
+    backup.scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+}
+
+void setEnabled(GLenum cap, GLboolean enabled) {
+    if (enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
+
+void restoreShaderState(const ShaderStateBackup& backup) {
+    const GLFunctions& gl = getGLFunctions();
+    gl.useProgram(backup.program);
+    glBindTexture(GL_TEXTURE_2D, backup.texture);
+    // the element array buffer binding is part of the vertex array state
+    gl.bindVertexArray(backup.vertexArray);
+    gl.bindBuffer(GL_ARRAY_BUFFER, backup.arrayBuffer);
+    gl.blendFuncSeparate(backup.blendSrcRgb, backup.blendDstRgb,
+                         backup.blendSrcAlpha, backup.blendDstAlpha);
+    setEnabled(GL_BLEND, backup.blend);
+    setEnabled(GL_CULL_FACE, backup.cullFace);
+    setEnabled(GL_DEPTH_TEST, backup.depthTest);
+    setEnabled(GL_SCISSOR_TEST, backup.scissorTest);
+    glViewport(backup.viewport[0], backup.viewport[1], backup.viewport[2],
+               backup.viewport[3]);
+    glScissor(backup.scissorBox[0], backup.scissorBox[1], backup.scissorBox[2],
+              backup.scissorBox[3]);
+}
+
+void setupFixedFunctionState(const ImVec2& displaySize, int fb_width, int fb_height) {
+    const GLFunctions& gl = getGLFunctions();
+    glEnable(GL_BLEND);
+    // separate alpha factors keep destination alpha right when drawing into
+    // a transparent render texture (see cacheRendering)
+    if (gl.blendFuncSeparate) {
+        gl.blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                             GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glDisable(GL_LIGHTING);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+
+    glMatrixMode(GL_TEXTURE);
+    glLoadIdentity();
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+
+#ifdef GL_VERSION_ES_CL_1_1
+    glOrthof(0.0f, displaySize.x, displaySize.y, 0.0f, -1.0f, +1.0f);
+#else
+    glOrtho(0.0f, displaySize.x, displaySize.y, 0.0f, -1.0f, +1.0f);
+#endif
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+void setupShaderState(ImGui::SFML::ImGuiSFMLContext& context, const ImVec2& displaySize,
+                      int fb_width, int fb_height, int textureUnit) {
+    const GLFunctions& gl = getGLFunctions();
+    ImGui::SFML::ImGuiSFMLContext::ShaderObjects& shader = context.shader;
+
+    if (textureUnit != 0) {
+        gl.activeTexture(GL_TEXTURE0 + textureUnit);
+    }
+
+    glEnable(GL_BLEND);
+    gl.blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                         GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
+
+    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+
+    // same projection as glOrtho(0, width, height, 0, -1, 1)
+    const float L = 0.0f, R = displaySize.x;
+    const float T = 0.0f, B = displaySize.y;
+    const GLfloat orthoProjection[16] = {
+        2.0f / (R - L),    0.0f,              0.0f,  0.0f,
+        0.0f,              2.0f / (T - B),    0.0f,  0.0f,
+        0.0f,              0.0f,              -1.0f, 0.0f,
+        (R + L) / (L - R), (T + B) / (B - T), 0.0f,  1.0f,
+    };
+    gl.useProgram(shader.program);
+    gl.uniform1i(shader.textureLocation, textureUnit);
+    gl.uniformMatrix4fv(shader.projectionLocation, 1, GL_FALSE, orthoProjection);
+
+    if (!shader.vertexArray) {
+        gl.genVertexArrays(1, &shader.vertexArray);
+    }
+    gl.bindVertexArray(shader.vertexArray);
+    gl.enableVertexAttribArray(shader.positionLocation);
+    gl.enableVertexAttribArray(shader.uvLocation);
+    gl.enableVertexAttribArray(shader.colorLocation);
+}
+
+// Fixed-function setup of minimalGLStateChanges: everything changed here is
+// either pushed on a GL stack or known from SFML's default state
+void setupMinimalFixedFunctionState(const ImVec2& displaySize, int fb_width, int fb_height) {
+    const GLFunctions& gl = getGLFunctions();
+
+    // client-side state, saving it doesn't need a round-trip to the driver.
+    // This keeps SFML's vertex pointers, which it may reuse for its next draw.
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+    // SFML's texture stays bound to unit 0, ImGui draws with unit 1
+    glDisable(GL_TEXTURE_2D);
+    gl.activeTexture(GL_TEXTURE1);
+    gl.clientActiveTexture(GL_TEXTURE1);
+    glEnable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    // same factors as sf::BlendAlpha, which prepareRenderTarget made SFML's
+    // last blend mode
+    glEnable(GL_BLEND);
+    gl.blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                         GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_SCISSOR_TEST);
+
+    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+
+    // unit 1's texture matrix isn't used by SFML
+    glMatrixMode(GL_TEXTURE);
+    glLoadIdentity();
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0f, displaySize.x, displaySize.y, 0.0f, -1.0f, +1.0f);
+
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+}
+
+void restoreMinimalFixedFunctionState() {
+    const GLFunctions& gl = getGLFunctions();
+
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_TEXTURE_2D);
+    gl.activeTexture(GL_TEXTURE0);
+    gl.clientActiveTexture(GL_TEXTURE0);
+    glEnable(GL_TEXTURE_2D);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+
+    glPopClientAttrib();
+}
+
+// Shader counterpart of restoreMinimalFixedFunctionState: SFML doesn't leave
+// any program, vertex array or buffer bound between its draws
+void restoreMinimalShaderState() {
+    const GLFunctions& gl = getGLFunctions();
+
+    gl.useProgram(0);
+    gl.bindVertexArray(0);
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.activeTexture(GL_TEXTURE0);
+    glDisable(GL_SCISSOR_TEST);
+}
+
+// Everything needed to hand GL back in the state it was in before
+// RenderDrawLists
+struct RenderStateBackup {
+    bool minimal;  // minimalGLStateChanges, if the GL context supports it
+    ShaderStateBackup shader;
+#ifdef GL_VERSION_ES_CL_1_1
+    GLint texture, arrayBuffer, elementArrayBuffer;
+#endif
+};
+
+void setupRenderState(ImGui::SFML::ImGuiSFMLContext& context, const ImVec2& displaySize,
+                      int fb_width, int fb_height, RenderStateBackup& backup) {
+    bool useShader = context.renderer == ImGui::SFML::Renderer_Shader;
+#ifdef GL_VERSION_ES_CL_1_1
+    backup.minimal = context.minimalGLStateChanges && useShader &&
+                     getGLFunctions().hasMultitexture;
+#else
+    backup.minimal =
+        context.minimalGLStateChanges && getGLFunctions().hasMultitexture;
+#endif
+
+    if (useShader) {
+        if (!backup.minimal) {
+            saveShaderState(backup.shader);
+        }
+        setupShaderState(context, displaySize, fb_width, fb_height, backup.minimal ? 1 : 0);
+        return;
+    }
+
+#ifdef GL_VERSION_ES_CL_1_1
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &backup.texture);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &backup.arrayBuffer);
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &backup.elementArrayBuffer);
+    setupFixedFunctionState(displaySize, fb_width, fb_height);
+#else
+    if (backup.minimal) {
+        setupMinimalFixedFunctionState(displaySize, fb_width, fb_height);
+    } else {
+        glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TRANSFORM_BIT);
+        setupFixedFunctionState(displaySize, fb_width, fb_height);
+    }
+#endif
+}
+
+void restoreRenderState(ImGui::SFML::ImGuiSFMLContext& context,
+                        const RenderStateBackup& backup, int fb_width,
+                        int fb_height, bool usedVertexBuffers) {
+    if (backup.minimal) {
+        if (context.renderer == ImGui::SFML::Renderer_Shader) {
+            restoreMinimalShaderState();
+        } else {
+#ifndef GL_VERSION_ES_CL_1_1
+            if (usedVertexBuffers) {
+                const GLFunctions& gl = getGLFunctions();
+                gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+                gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            }
+            restoreMinimalFixedFunctionState();
+#endif
+        }
+
+        const int* viewport = context.targetViewport;
+        if (viewport[2] > 0 && viewport[3] > 0) {
+            glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        } else {
+            glViewport(0, 0, fb_width, fb_height);
+        }
+        return;
+    }
+
+    if (context.renderer == ImGui::SFML::Renderer_Shader) {
+        restoreShaderState(backup.shader);
+        return;
+    }
+
+#ifdef GL_VERSION_ES_CL_1_1
+    glBindTexture(GL_TEXTURE_2D, backup.texture);
+    glBindBuffer(GL_ARRAY_BUFFER, backup.arrayBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, backup.elementArrayBuffer);
+    glDisable(GL_SCISSOR_TEST);
+#else
+    if (usedVertexBuffers) {
+        // SFML draws from client-side arrays, which only works with no buffer bound
+        const GLFunctions& gl = getGLFunctions();
+        gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+        gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+    glPopAttrib();
+#endif
+}
+
+void setVertexPointers(ImGui::SFML::ImGuiSFMLContext& context,
+                       const unsigned char* vtx_buffer) {
+    if (context.renderer == ImGui::SFML::Renderer_Shader) {
+        const GLFunctions& gl = getGLFunctions();
+        const ImGui::SFML::ImGuiSFMLContext::ShaderObjects& shader = context.shader;
+        gl.vertexAttribPointer(shader.positionLocation, 2, GL_FLOAT, GL_FALSE,
+                               sizeof(ImDrawVert),
+                               (void*)(vtx_buffer + offsetof(ImDrawVert, pos)));
+        gl.vertexAttribPointer(shader.uvLocation, 2, GL_FLOAT, GL_FALSE,
+                               sizeof(ImDrawVert),
+                               (void*)(vtx_buffer + offsetof(ImDrawVert, uv)));
+        gl.vertexAttribPointer(shader.colorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                               sizeof(ImDrawVert),
+                               (void*)(vtx_buffer + offsetof(ImDrawVert, col)));
+    } else {
+        glVertexPointer(2, GL_FLOAT, sizeof(ImDrawVert),
+                        (void*)(vtx_buffer + offsetof(ImDrawVert, pos)));
+        glTexCoordPointer(2, GL_FLOAT, sizeof(ImDrawVert),
+                          (void*)(vtx_buffer + offsetof(ImDrawVert, uv)));
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ImDrawVert),
+                       (void*)(vtx_buffer + offsetof(ImDrawVert, col)));
+    }
+}
+
+// Remembers the texture and scissor box set while submitting draw commands,
+// so that redundant GL calls can be skipped
+struct RenderStateCache {
+    RenderStateCache(ImGui::SFML::ImGuiSFMLContext::RenderStats& stats)
+        : stats(stats), textureValid(false), texture(0), scissorValid(false) {}
+
+    // call after anything (e.g. a user callback) might have changed GL state
+    void invalidate() {
+        textureValid = false;
+        scissorValid = false;
+    }
+
+    void bindTexture(GLuint handle) {
+        if (textureValid && texture == handle) {
+            ++stats.skippedTextureBinds;
+            return;
+        }
+        glBindTexture(GL_TEXTURE_2D, handle);
+        texture = handle;
+        textureValid = true;
+        ++stats.textureBinds;
+    }
+
+    void setScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+        if (scissorValid && scissor[0] == x && scissor[1] == y &&
+            scissor[2] == width && scissor[3] == height) {
+            ++stats.skippedScissorChanges;
+            return;
+        }
+        glScissor(x, y, width, height);
+        scissor[0] = x;
+        scissor[1] = y;
+        scissor[2] = width;
+        scissor[3] = height;
+        scissorValid = true;
+        ++stats.scissorChanges;
+    }
+
+    ImGui::SFML::ImGuiSFMLContext::RenderStats& stats;
+    bool textureValid;
+    GLuint texture;
+    bool scissorValid;
+    GLint scissor[4];
+};
+
+// Commands can be drawn with one glDrawElements if they follow each other in
+// the same draw list and only differ in their index range
+bool canMergeDrawCommands(const ImDrawCmd& a, const ImDrawCmd& b) {
+    return !a.UserCallback && !b.UserCallback && a.TextureId == b.TextureId &&
+#if IMGUI_VERSION_NUM >= 17100
+           a.VtxOffset == b.VtxOffset &&
+#endif
+           a.ClipRect.x == b.ClipRect.x && a.ClipRect.y == b.ClipRect.y &&
+           a.ClipRect.z == b.ClipRect.z && a.ClipRect.w == b.ClipRect.w;
+}
+
+// ImDrawIdx is 16-bit unless imconfig.h defines it as unsigned int.
+// (GLES 1 needs OES_element_index_uint for 32-bit indices.)
+const GLenum INDEX_TYPE =
+    sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+// Rendering callback. Only uses draw_data and the render fields of the context,
+// so that snapshots can be drawn while another thread builds the next frame.
+void RenderDrawLists(ImGui::SFML::ImGuiSFMLContext& context, ImDrawData* draw_data,
+                     const ImVec2& framebufferScale) {
+    ProfileTimer timer(context, &FrameProfile::submitMs);
+    ImGui::SFML::ImGuiSFMLContext::RenderStats& stats = context.renderStats;
+    stats = ImGui::SFML::ImGuiSFMLContext::RenderStats();
+    if (draw_data->CmdListsCount == 0) {
+        return;
+    }
+
+    // scale stuff (needed for proper handling of window resize)
+    const ImVec2& displaySize = draw_data->DisplaySize;
+    int fb_width = static_cast<int>(displaySize.x * framebufferScale.x);
+    int fb_height = static_cast<int>(displaySize.y * framebufferScale.y);
+    if (fb_width == 0 || fb_height == 0) {
+        return;
+    }
+
+    GPUTimer* gpuTimer = context.gpuTiming ? beginGPUTiming(context, draw_data) : NULL;
+    bool timeLists = gpuTimer && gpuTimer->sets[gpuTimer->next].lists.Size > 0;
+
+    uploadDynamicGlyphs(context);
+
+    bool useShader = context.renderer == ImGui::SFML::Renderer_Shader;
+    RenderStateBackup stateBackup;
+    setupRenderState(context, displaySize, fb_width, fb_height, stateBackup);
+
+    // with buffer objects, vertex and index "pointers" are offsets into the
+    // streaming buffers which hold the data of the whole frame. The shader
+    // path always uses them (Init made sure they're available).
+    std::size_t vtxOffset = 0, idxOffset = 0;
+    bool useVertexBuffers =
+        (useShader || context.useVertexBuffers) &&
+        uploadDrawData(context, draw_data, vtxOffset, idxOffset);
+
+    RenderStateCache stateCache(stats);
+    const ImVec2& clipScale = framebufferScale;
+    ImTextureID textureID = (ImTextureID)NULL;
+    GLuint textureHandle = 0;
+    bool textureValid = false;
+
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const unsigned char* vtx_buffer =
+            useVertexBuffers
+                ? reinterpret_cast<const unsigned char*>(vtxOffset)
+                : (const unsigned char*)cmd_list->VtxBuffer.Data;
+        const ImDrawIdx* idx_buffer =
+            useVertexBuffers ? reinterpret_cast<const ImDrawIdx*>(idxOffset)
+                             : cmd_list->IdxBuffer.Data;
+        vtxOffset += cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+        idxOffset += cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+
+        setVertexPointers(context, vtx_buffer);
+#if IMGUI_VERSION_NUM >= 17100
+        unsigned int currentVtxOffset = 0;
+#endif
+
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.size(); ++cmd_i) {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback) {
+                pcmd->UserCallback(cmd_list, pcmd);
+                stateCache.invalidate();
+                idx_buffer += pcmd->ElemCount;
+                continue;
+            }
+
+            // fold the following commands which only continue this one
+            unsigned int elemCount = pcmd->ElemCount;
+            while (cmd_i + 1 < cmd_list->CmdBuffer.size() &&
+                   canMergeDrawCommands(*pcmd, cmd_list->CmdBuffer[cmd_i + 1])) {
+                ++cmd_i;
+                elemCount += cmd_list->CmdBuffer[cmd_i].ElemCount;
+                ++stats.mergedCommands;
+            }
+
+            // clip rects are in display coordinates, the scissor box is in
+            // framebuffer pixels with the origin at the bottom-left corner
+            ImVec4 clipRect(pcmd->ClipRect.x * clipScale.x, pcmd->ClipRect.y * clipScale.y,
+                            pcmd->ClipRect.z * clipScale.x, pcmd->ClipRect.w * clipScale.y);
+            if (clipRect.z <= clipRect.x || clipRect.w <= clipRect.y ||
+                clipRect.x >= fb_width || clipRect.y >= fb_height ||
+                clipRect.z <= 0.0f || clipRect.w <= 0.0f || elemCount == 0) {
+                ++stats.culledCommands;
+                idx_buffer += elemCount;
+                continue;
+            }
+
+#if IMGUI_VERSION_NUM >= 17100
+            // indices are relative to VtxOffset. Moving the vertex pointers
+            // instead of using a base-vertex draw also works on GL < 3.2 / GLES.
+            if (pcmd->VtxOffset != currentVtxOffset) {
+                currentVtxOffset = pcmd->VtxOffset;
+                setVertexPointers(context,
+                                  vtx_buffer + currentVtxOffset * sizeof(ImDrawVert));
+            }
+#endif
+
+            // textures are only looked up when they change
+            if (!textureValid || pcmd->TextureId != textureID) {
+                textureID = pcmd->TextureId;
+                textureValid = resolveTextureID(context, textureID, textureHandle);
+            }
+            if (!textureValid) {
+                ++stats.invalidTextureCommands;
+                idx_buffer += elemCount;
+                continue;
+            }
+            stateCache.bindTexture(textureHandle);
+            stateCache.setScissor((int)clipRect.x, (int)(fb_height - clipRect.w),
+                                  (int)(clipRect.z - clipRect.x),
+                                  (int)(clipRect.w - clipRect.y));
+            glDrawElements(GL_TRIANGLES, (GLsizei)elemCount, INDEX_TYPE, idx_buffer);
+            ++stats.drawCalls;
+            idx_buffer += elemCount;
+        }
+
+        if (timeLists) {
+            queryGPUTimestamp(*gpuTimer);
+        }
+    }
+
+    restoreRenderState(context, stateBackup, fb_width, fb_height, useVertexBuffers);
+    if (gpuTimer) {
+        endGPUTiming(*gpuTimer);
+    }
+    if (context.enableProfiler) {
+        recordSubmitProfile(context, draw_data);
+    }
+}
+
+void beginFrameProfile(ImGui::SFML::ImGuiSFMLContext& context) {
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    int size = ImMax(context.profilerHistorySize, 1);
+    if (context.profilerHistory.Size != size) {
+        context.profilerHistory.resize(size);
+        context.profilerHistoryNext = 0;
+        context.profilerHistoryCount = 0;
+    }
+    if (context.profilerFrameStarted) {
+        context.profilerHistory[context.profilerHistoryNext] = context.profilerFrame;
+        context.profilerHistoryNext = (context.profilerHistoryNext + 1) % size;
+        context.profilerHistoryCount = ImMin(context.profilerHistoryCount + 1, size);
+    }
+    context.profilerFrameStarted = true;
+    context.profilerFrame = context.profilerPending;
+    context.profilerPending = FrameProfile();
+}
+
+void recordSubmitProfile(ImGui::SFML::ImGuiSFMLContext& context, const ImDrawData* draw_data) {
+    const ImGui::SFML::ImGuiSFMLContext::RenderStats& stats = context.renderStats;
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    FrameProfile& profile = context.profilerFrame;
+    profile.vertices += (unsigned int)draw_data->TotalVtxCount;
+    profile.indices += (unsigned int)draw_data->TotalIdxCount;
+    profile.drawCalls += stats.drawCalls;
+    profile.textureBinds += stats.textureBinds;
+    profile.scissorChanges += stats.scissorChanges;
+}
+
+GPUTimer* beginGPUTiming(ImGui::SFML::ImGuiSFMLContext& context, const ImDrawData* draw_data) {
+    const GLFunctions& gl = getGLFunctions();
+    if (!gl.hasTimerQuery || !context.gpuTimer) {
+        return NULL;
+    }
+    GPUTimer& timer = *context.gpuTimer;
+    readGPUTimings(context, timer);
+
+    // waiting for the oldest set would stall the CPU, so this render isn't timed
+    GPUTimer::QuerySet& set = timer.sets[timer.next];
+    if (set.pending) {
+        std::lock_guard<std::mutex> lock(context.snapshotMutex);
+        ++context.gpuTimings.skippedRenders;
+        return NULL;
+    }
+
+    bool perList = context.gpuTimingPerList && draw_data->CmdListsCount > 0 &&
+                   draw_data->CmdListsCount <= GPUTimer::MAX_LISTS;
+    int queryCount = perList ? draw_data->CmdListsCount + 1 : 2;
+    if (set.queries.Size < queryCount) {
+        int oldSize = set.queries.Size;
+        set.queries.resize(queryCount);
+        gl.genQueries(queryCount - oldSize, set.queries.Data + oldSize);
+    }
+    set.lists.resize(perList ? draw_data->CmdListsCount : 0);
+    for (int n = 0; n < set.lists.Size; ++n) {
+        const char* owner = draw_data->CmdLists[n]->_OwnerName;
+        ImFormatString(set.lists[n].owner, IM_ARRAYSIZE(set.lists[n].owner), "%s",
+                       owner ? owner : "");
+        set.lists[n].ms = 0.f;
+    }
+
+    set.count = 0;
+    queryGPUTimestamp(timer);
+    return &timer;
+}
+
+void queryGPUTimestamp(GPUTimer& timer) {
+    GPUTimer::QuerySet& set = timer.sets[timer.next];
+    getGLFunctions().queryCounter(set.queries[set.count], GL_TIMESTAMP);
+    ++set.count;
+}
+
+void endGPUTiming(GPUTimer& timer) {
+    GPUTimer::QuerySet& set = timer.sets[timer.next];
+    if (set.count == 1) {
+        queryGPUTimestamp(timer);
+    }
+    set.pending = true;
+    set.render = ++timer.render;
+    timer.next = (timer.next + 1) % GPUTimer::SET_COUNT;
+}
+
+void readGPUTimings(ImGui::SFML::ImGuiSFMLContext& context, GPUTimer& timer) {
+    const GLFunctions& gl = getGLFunctions();
+
+    // oldest first: queries complete in order, so the first set which isn't
+    // available yet ends the readback
+    for (int i = 0; i < GPUTimer::SET_COUNT; ++i) {
+        GPUTimer::QuerySet& set = timer.sets[(timer.next + i) % GPUTimer::SET_COUNT];
+        if (!set.pending) {
+            continue;
+        }
+        GLuint available = 0;
+        gl.getQueryObjectuiv(set.queries[set.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        set.pending = false;
+
+        // timestamps can't be compared across a disjoint operation (GPU
+        // frequency change, context loss...), reading the flag resets it
+        if (gl.timerQueryDisjoint) {
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            if (disjoint) {
+                std::lock_guard<std::mutex> lock(context.snapshotMutex);
+                ++context.gpuTimings.skippedRenders;
+                continue;
+            }
+        }
+
+        // nanoseconds
+        sf::Uint64 start = 0, previous = 0, end = 0;
+        gl.getQueryObjectui64v(set.queries[0], GL_QUERY_RESULT, &start);
+        previous = start;
+        for (int q = 1; q < set.count; ++q) {
+            gl.getQueryObjectui64v(set.queries[q], GL_QUERY_RESULT, &end);
+            if (q - 1 < set.lists.Size) {
+                set.lists[q - 1].ms = (float)(end - previous) / 1000000.f;
+            }
+            previous = end;
+        }
+
+        std::lock_guard<std::mutex> lock(context.snapshotMutex);
+        ImGui::SFML::ImGuiSFMLContext::GPUTimings& timings = context.gpuTimings;
+        timings.render = set.render;
+        timings.totalMs = (float)(end - start) / 1000000.f;
+        timings.lists.resize(set.lists.Size);  // reserved by Init
+        if (set.lists.Size > 0) {
+            memcpy(timings.lists.Data, set.lists.Data, set.lists.Size * sizeof(set.lists[0]));
+        }
+        if (context.enableProfiler) {
+            context.profilerFrame.gpuMs = timings.totalMs;
+        }
+    }
+}
+
+void destroyGPUTimer(ImGui::SFML::ImGuiSFMLContext& context) {
+    if (!context.gpuTimer) {
+        return;
+    }
+    const GLFunctions& gl = getGLFunctions();
+    for (int i = 0; i < GPUTimer::SET_COUNT; ++i) {
+        ImVector<unsigned int>& queries = context.gpuTimer->sets[i].queries;
+        if (!queries.empty()) {
+            gl.deleteQueries(queries.Size, queries.Data);
+        }
+    }
+    IM_DELETE(context.gpuTimer);
+    context.gpuTimer = NULL;
+}
+
+}  // end of anonymous namespace
+
+// Half-space edges use double precision, so that edges shared by two
+// triangles give exactly the same span limits and pixels aren't drawn twice
+struct ImGui::SFML::ImGuiSFMLContext::SoftwareTriangle {
+    double edgeA[3], edgeB[3], edgeC[3];  // inside where A * x + B * y + C > 0
+    float origin[6], dx[6], dy[6];  // planes of u, v, r, g, b, a (colors in [0, 1])
+    int minX, minY, maxX, maxY;     // bounds clipped to the scissor rect, max excluded
+    const unsigned int* texels;     // NULL if the whole triangle uses one texel
+    int texWidth, texHeight;
+    unsigned int texel;
+};
+
+// Worker threads of RenderToImage, each one rasterizes the band of its index.
+// A render bumps the generation to start them and waits until none is pending.
+struct ImGui::SFML::ImGuiSFMLContext::SoftwareWorkers {
+    static const int MAX_THREADS = 63;  // RenderToImage uses up to 64 bands
+
+    SoftwareWorkers() : threadCount(0), generation(0), pending(0), quit(false),
+                        pixels(NULL), width(0), height(0), bandCount(0) {}
+
+    std::thread threads[MAX_THREADS];  // threads[i] rasterizes band i + 1
+    int threadCount;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    unsigned int generation;
+    int pending;
+    bool quit;
+
+    // the current render, written under the mutex
+    const SoftwareTriangle* triangles;
+    int triangleCount;
+    unsigned int* pixels;
+    int width, height;
+    int bandCount;
+};
+
+namespace {
+
+typedef ImGui::SFML::ImGuiSFMLContext::SoftwareTriangle SoftwareTriangle;
+typedef ImGui::SFML::ImGuiSFMLContext::SoftwareWorkers SoftwareWorkers;
+
+// Texels are fetched with nearest filtering, which matches the GL path for
+// unscaled text and solid fills (ImGui's white pixel)
+inline unsigned int sampleTexel(const unsigned int* texels, int width, int height,
+                                float u, float v) {
+    int x = static_cast<int>(u * width);
+    int y = static_cast<int>(v * height);
+    x = x < 0 ? 0 : (x >= width ? width - 1 : x);
+    y = y < 0 ? 0 : (y >= height ? height - 1 : y);
+    return texels[y * width + x];
+}
+
+void setupSoftwareTriangle(ImVector<SoftwareTriangle>& triangles, const ImDrawVert* v0,
+                           const ImDrawVert* v1, const ImDrawVert* v2,
+                           const ImVec2& scale, const int clip[4],
+                           const unsigned int* texels, int texWidth, int texHeight) {
+    double x0 = v0->pos.x * scale.x, y0 = v0->pos.y * scale.y;
+    double x1 = v1->pos.x * scale.x, y1 = v1->pos.y * scale.y;
+    double x2 = v2->pos.x * scale.x, y2 = v2->pos.y * scale.y;
+    double det = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+    if (det == 0.0) {
+        return;
+    }
+
+    int minX = std::max(clip[0], (int)std::floor(std::min(x0, std::min(x1, x2))));
+    int minY = std::max(clip[1], (int)std::floor(std::min(y0, std::min(y1, y2))));
+    int maxX = std::min(clip[2], (int)std::ceil(std::max(x0, std::max(x1, x2))));
+    int maxY = std::min(clip[3], (int)std::ceil(std::max(y0, std::max(y1, y2))));
+    if (minX >= maxX || minY >= maxY) {
+        return;
+    }
+
+    triangles.resize(triangles.Size + 1);
+    SoftwareTriangle& tri = triangles.back();
+    tri.minX = minX;
+    tri.minY = minY;
+    tri.maxX = maxX;
+    tri.maxY = maxY;
+
+    // edge i goes from vertex i to vertex i + 1, flipped for clockwise triangles
+    const double xs[3] = {x0, x1, x2}, ys[3] = {y0, y1, y2};
+    double orientation = det > 0.0 ? 1.0 : -1.0;
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3;
+        tri.edgeA[i] = orientation * (ys[i] - ys[j]);
+        tri.edgeB[i] = orientation * (xs[j] - xs[i]);
+        tri.edgeC[i] = orientation * (xs[i] * ys[j] - xs[j] * ys[i]);
+    }
+
+    const ImDrawVert* vertices[3] = {v0, v1, v2};
+    float attributes[3][6];
+    for (int i = 0; i < 3; ++i) {
+        ImU32 col = vertices[i]->col;
+        attributes[i][0] = vertices[i]->uv.x;
+        attributes[i][1] = vertices[i]->uv.y;
+        attributes[i][2] = ((col >> IM_COL32_R_SHIFT) & 0xFF) / 255.f;
+        attributes[i][3] = ((col >> IM_COL32_G_SHIFT) & 0xFF) / 255.f;
+        attributes[i][4] = ((col >> IM_COL32_B_SHIFT) & 0xFF) / 255.f;
+        attributes[i][5] = ((col >> IM_COL32_A_SHIFT) & 0xFF) / 255.f;
+    }
+    for (int k = 0; k < 6; ++k) {
+        double d1 = attributes[1][k] - attributes[0][k];
+        double d2 = attributes[2][k] - attributes[0][k];
+        double dx = (d1 * (y2 - y0) - d2 * (y1 - y0)) / det;
+        double dy = (d2 * (x1 - x0) - d1 * (x2 - x0)) / det;
+        tri.dx[k] = (float)dx;
+        tri.dy[k] = (float)dy;
+        tri.origin[k] = (float)(attributes[0][k] - dx * x0 - dy * y0);
+    }
+
+    tri.texWidth = texWidth;
+    tri.texHeight = texHeight;
+    bool constantUV = v0->uv.x == v1->uv.x && v0->uv.x == v2->uv.x &&
+                      v0->uv.y == v1->uv.y && v0->uv.y == v2->uv.y;
+    if (!texels) {
+        tri.texels = NULL;
+        tri.texel = 0xFFFFFFFF;
+    } else if (constantUV) {
+        tri.texels = NULL;
+        tri.texel = sampleTexel(texels, texWidth, texHeight, v0->uv.x, v0->uv.y);
+    } else {
+        tri.texels = texels;
+        tri.texel = 0;
+    }
+}
+
+void setupSoftwareTriangles(ImGui::SFML::ImGuiSFMLContext& context,
+                            const ImDrawData* draw_data, const ImVec2& framebufferScale,
+                            int width, int height) {
+    ImVector<SoftwareTriangle>& triangles = context.softwareTriangles;
+    triangles.resize(0);
+
+    const ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const ImDrawIdx* idx_buffer = cmd_list->IdxBuffer.Data;
+
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; ++cmd_i) {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            // callbacks expect the GL renderer, there's nothing they could do here
+            if (pcmd->UserCallback) {
+                idx_buffer += pcmd->ElemCount;
+                continue;
+            }
+
+            int clip[4] = {
+                std::max(0, (int)(pcmd->ClipRect.x * framebufferScale.x)),
+                std::max(0, (int)(pcmd->ClipRect.y * framebufferScale.y)),
+                std::min(width, (int)(pcmd->ClipRect.z * framebufferScale.x)),
+                std::min(height, (int)(pcmd->ClipRect.w * framebufferScale.y))};
+
+            // unknown textures are drawn untextured
+            const unsigned int* texels = NULL;
+            int texWidth = 0, texHeight = 0;
+            if (pcmd->TextureId == fonts->TexID) {
+                texels = fonts->TexPixelsRGBA32;
+                texWidth = fonts->TexWidth;
+                texHeight = fonts->TexHeight;
+            } else {
+                for (int i = 0; i < context.softwareTextures.Size; ++i) {
+                    if (context.softwareTextures[i].id == pcmd->TextureId) {
+                        const sf::Image* image = context.softwareTextures[i].image;
+                        texels = reinterpret_cast<const unsigned int*>(image->getPixelsPtr());
+                        texWidth = (int)image->getSize().x;
+                        texHeight = (int)image->getSize().y;
+                        break;
+                    }
+                }
+            }
+            if (texWidth == 0 || texHeight == 0) {
+                texels = NULL;
+            }
+
+            const ImDrawVert* vtx_buffer = cmd_list->VtxBuffer.Data;
+#if IMGUI_VERSION_NUM >= 17100
+            vtx_buffer += pcmd->VtxOffset;
+#endif
+            if (clip[0] < clip[2] && clip[1] < clip[3]) {
+                for (unsigned int i = 0; i + 2 < pcmd->ElemCount; i += 3) {
+                    setupSoftwareTriangle(triangles, &vtx_buffer[idx_buffer[i]],
+                                          &vtx_buffer[idx_buffer[i + 1]],
+                                          &vtx_buffer[idx_buffer[i + 2]], framebufferScale,
+                                          clip, texels, texWidth, texHeight);
+                }
+            }
+            idx_buffer += pcmd->ElemCount;
+        }
+    }
+}
+
+// Blends like the GL path: src * srcAlpha + dst * (1 - srcAlpha) for colors
+// and src + dst * (1 - srcAlpha) for alpha. Source is the vertex color (in
+// [0, 1]) times the texel (in [0, 255]).
+inline unsigned int blendPixel(unsigned int dst, unsigned int texel, float r,
+                               float g, float b, float a) {
+    float sr = r * (texel & 0xFF);
+    float sg = g * ((texel >> 8) & 0xFF);
+    float sb = b * ((texel >> 16) & 0xFF);
+    float sa = a * (texel >> 24);
+    float alpha = sa * (1.f / 255.f);
+    float inv = 1.f - alpha;
+
+    unsigned int dr = (unsigned int)(sr * alpha + (dst & 0xFF) * inv + 0.5f);
+    unsigned int dg = (unsigned int)(sg * alpha + ((dst >> 8) & 0xFF) * inv + 0.5f);
+    unsigned int db = (unsigned int)(sb * alpha + ((dst >> 16) & 0xFF) * inv + 0.5f);
+    unsigned int da = (unsigned int)(sa + (dst >> 24) * inv + 0.5f);
+    return std::min(dr, 255u) | (std::min(dg, 255u) << 8) | (std::min(db, 255u) << 16) |
+           (std::min(da, 255u) << 24);
+}
+
+void fillSpan(const SoftwareTriangle& tri, unsigned int* row, int xBegin, int xEnd,
+              float yc) {
+    float base[6];
+    for (int k = 0; k < 6; ++k) {
+        base[k] = tri.origin[k] + tri.dy[k] * yc;
+    }
+
+    int x = xBegin;
+#ifdef IMGUI_SFML_SSE2
+    // 4 pixels at a time, channels in separate registers
+    const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 inv255 = _mm_set1_ps(1.f / 255.f);
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    __m128 planes[6], steps[6];
+    for (int k = 0; k < 6; ++k) {
+        planes[k] = _mm_set1_ps(base[k]);
+        steps[k] = _mm_set1_ps(tri.dx[k]);
+    }
+
+    for (; x + 4 <= xEnd; x += 4) {
+        __m128 xc = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+        __m128 attr[6];
+        for (int k = tri.texels ? 0 : 2; k < 6; ++k) {
+            attr[k] = _mm_add_ps(planes[k], _mm_mul_ps(steps[k], xc));
+        }
+
+        __m128i texel;
+        if (tri.texels) {
+            float u[4], v[4];
+            _mm_storeu_ps(u, attr[0]);
+            _mm_storeu_ps(v, attr[1]);
+            texel = _mm_set_epi32(
+                (int)sampleTexel(tri.texels, tri.texWidth, tri.texHeight, u[3], v[3]),
+                (int)sampleTexel(tri.texels, tri.texWidth, tri.texHeight, u[2], v[2]),
+                (int)sampleTexel(tri.texels, tri.texWidth, tri.texHeight, u[1], v[1]),
+                (int)sampleTexel(tri.texels, tri.texWidth, tri.texHeight, u[0], v[0]));
+        } else {
+            texel = _mm_set1_epi32((int)tri.texel);
+        }
+
+        __m128 sr = _mm_mul_ps(attr[2], _mm_cvtepi32_ps(_mm_and_si128(texel, byteMask)));
+        __m128 sg = _mm_mul_ps(
+            attr[3], _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texel, 8), byteMask)));
+        __m128 sb = _mm_mul_ps(
+            attr[4], _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texel, 16), byteMask)));
+        __m128 sa = _mm_mul_ps(attr[5], _mm_cvtepi32_ps(_mm_srli_epi32(texel, 24)));
+        __m128 alpha = _mm_mul_ps(sa, inv255);
+        __m128 inv = _mm_sub_ps(one, alpha);
+
+        __m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        __m128 dr = _mm_cvtepi32_ps(_mm_and_si128(dst, byteMask));
+        __m128 dg = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dst, 8), byteMask));
+        __m128 db = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dst, 16), byteMask));
+        __m128 da = _mm_cvtepi32_ps(_mm_srli_epi32(dst, 24));
+
+        // _mm_cvtps_epi32 rounds to nearest, results are already in [0, 255]
+        __m128i r = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(sr, alpha), _mm_mul_ps(dr, inv)));
+        __m128i g = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(sg, alpha), _mm_mul_ps(dg, inv)));
+        __m128i b = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(sb, alpha), _mm_mul_ps(db, inv)));
+        __m128i a = _mm_cvtps_epi32(_mm_add_ps(sa, _mm_mul_ps(da, inv)));
+        __m128i result = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(r, byteMask),
+                         _mm_slli_epi32(_mm_and_si128(g, byteMask), 8)),
+            _mm_or_si128(_mm_slli_epi32(_mm_and_si128(b, byteMask), 16),
+                         _mm_slli_epi32(a, 24)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), result);
+    }
+#endif
+
+    for (; x < xEnd; ++x) {
+        float xc = x + 0.5f;
+        unsigned int texel =
+            tri.texels ? sampleTexel(tri.texels, tri.texWidth, tri.texHeight,
+                                     base[0] + tri.dx[0] * xc, base[1] + tri.dx[1] * xc)
+                       : tri.texel;
+        row[x] = blendPixel(row[x], texel, base[2] + tri.dx[2] * xc,
+                            base[3] + tri.dx[3] * xc, base[4] + tri.dx[4] * xc,
+                            base[5] + tri.dx[5] * xc);
+    }
+}
+
+void rasterizeBand(const SoftwareTriangle* triangles, int count, unsigned int* pixels,
+                   int width, int yBegin, int yEnd) {
+    for (int t = 0; t < count; ++t) {
+        const SoftwareTriangle& tri = triangles[t];
+        int y0 = std::max(tri.minY, yBegin);
+        int y1 = std::min(tri.maxY, yEnd);
+
+        for (int y = y0; y < y1; ++y) {
+            // pixel centers inside all three edges. Centers exactly on an edge
+            // belong to the triangle on its right (or below for horizontal edges).
+            double yc = y + 0.5;
+            int xBegin = tri.minX, xEnd = tri.maxX;
+            for (int e = 0; e < 3 && xBegin < xEnd; ++e) {
+                double a = tri.edgeA[e];
+                double k = tri.edgeB[e] * yc + tri.edgeC[e];
+                if (a == 0.0) {
+                    if (!(k > 0.0 || (k == 0.0 && tri.edgeB[e] > 0.0))) {
+                        xBegin = xEnd;
+                    }
+                    continue;
+                }
+                double t = -k / a - 0.5;
+                t = std::max((double)tri.minX - 1.0, std::min((double)tri.maxX + 1.0, t));
+                int limit = (int)std::ceil(t);
+                if (a > 0.0) {
+                    xBegin = std::max(xBegin, limit);
+                } else {
+                    xEnd = std::min(xEnd, limit);
+                }
+            }
+
+            if (xBegin < xEnd) {
+                fillSpan(tri, pixels + y * width, xBegin, xEnd, (float)yc);
+            }
+        }
+    }
+}
+
+void runSoftwareWorker(SoftwareWorkers* workers, int band, unsigned int generation) {
+    std::unique_lock<std::mutex> lock(workers->mutex);
+    for (;;) {
+        while (!workers->quit && workers->generation == generation) {
+            workers->start.wait(lock);
+        }
+        if (workers->quit) {
+            return;
+        }
+        generation = workers->generation;
+
+        if (band < workers->bandCount) {
+            const SoftwareTriangle* triangles = workers->triangles;
+            int triangleCount = workers->triangleCount;
+            unsigned int* pixels = workers->pixels;
+            int width = workers->width;
+            int height = workers->height;
+            int bandHeight = (height + workers->bandCount - 1) / workers->bandCount;
+            lock.unlock();
+            rasterizeBand(triangles, triangleCount, pixels, width,
+                          std::min(height, band * bandHeight),
+                          std::min(height, (band + 1) * bandHeight));
+            lock.lock();
+        }
+        if (--workers->pending == 0) {
+            workers->done.notify_one();
+        }
+    }
+}
+
+void rasterizeBands(ImGui::SFML::ImGuiSFMLContext& context, unsigned int* pixels, int width,
+                    int height, int bandCount) {
+    const SoftwareTriangle* triangles = context.softwareTriangles.Data;
+    int triangleCount = context.softwareTriangles.Size;
+    int bandHeight = (height + bandCount - 1) / bandCount;
+    assert(bandCount <= SoftwareWorkers::MAX_THREADS + 1);
+    if (bandCount <= 1) {
+        rasterizeBand(triangles, triangleCount, pixels, width, 0, height);
+        return;
+    }
+
+    if (!context.softwareWorkers) {
+        context.softwareWorkers = IM_NEW(SoftwareWorkers)();
+    }
+    SoftwareWorkers& workers = *context.softwareWorkers;
+    {
+        std::lock_guard<std::mutex> lock(workers.mutex);
+        workers.triangles = triangles;
+        workers.triangleCount = triangleCount;
+        workers.pixels = pixels;
+        workers.width = width;
+        workers.height = height;
+        workers.bandCount = bandCount;
+        // new threads wait for the next generation, which is this render
+        while (workers.threadCount < bandCount - 1) {
+            workers.threads[workers.threadCount] = std::thread(
+                runSoftwareWorker, &workers, workers.threadCount + 1, workers.generation);
+            ++workers.threadCount;
+        }
+        workers.pending = workers.threadCount;
+        ++workers.generation;
+    }
+    workers.start.notify_all();
+
+    rasterizeBand(triangles, triangleCount, pixels, width, 0, std::min(height, bandHeight));
+
+    std::unique_lock<std::mutex> lock(workers.mutex);
+    while (workers.pending > 0) {
+        workers.done.wait(lock);
+    }
+}
+
+void destroySoftwareWorkers(ImGui::SFML::ImGuiSFMLContext& context) {
+    SoftwareWorkers* workers = context.softwareWorkers;
+    if (!workers) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers->mutex);
+        workers->quit = true;
+    }
+    workers->start.notify_all();
+    for (int i = 0; i < workers->threadCount; ++i) {
+        workers->threads[i].join();
+    }
+    IM_DELETE(workers);
+    context.softwareWorkers = NULL;
+}
+
+void setCurrentContext(ImGui::SFML::ImGuiSFMLContext& context) {
+    s_currentContext = &context;
+    ImGui::SetCurrentContext(context.imguiContext);
+}
+
+// Prepended to every block allocated for ImGui, so that it's freed with the
+// allocator it came from, even if another context is current by then
+union AllocationHeader {
+    struct Info {
+        void (*freeFunc)(void* ptr, void* userData);  // NULL for free()
+        void* userData;
+        size_t size;
+    } info;
+    double alignDouble;
+    long long alignLong;
+};
+
+void installAllocatorFunctions() {
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        ImGui::SetAllocatorFunctions(allocWithCurrentContext, freeWithOwnAllocator);
+    });
+}
+
+void* allocWithCurrentContext(size_t size, void* /* userData */) {
+    ImGui::SFML::ImGuiSFMLContext* context = s_currentContext;
+    const ImGui::SFML::ImGuiSFMLContext::Allocator* allocator =
+        context && context->allocator.allocFunc ? &context->allocator : NULL;
+
+    size_t blockSize = sizeof(AllocationHeader) + size;
+    void* block = allocator ? allocator->allocFunc(blockSize, allocator->userData)
+                            : malloc(blockSize);
+    if (!block) {
+        return NULL;
+    }
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(block);
+    header->info.freeFunc = allocator ? allocator->freeFunc : NULL;
+    header->info.userData = allocator ? allocator->userData : NULL;
+    header->info.size = size;
+
+    if (context) {
+        ImGui::SFML::ImGuiSFMLContext::AllocationStats& stats = context->allocationStats;
+        ++stats.frameAllocations;
+        stats.frameBytes += size;
+        ++stats.totalAllocations;
+        stats.bytesInUse += size;
+    }
+    return header + 1;
+}
+
+void freeWithOwnAllocator(void* ptr, void* /* userData */) {
+    if (!ptr) {
+        return;
+    }
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+    if (s_currentContext) {
+        size_t& bytesInUse = s_currentContext->allocationStats.bytesInUse;
+        bytesInUse -= std::min(bytesInUse, header->info.size);
+    }
+
+    if (header->info.freeFunc) {
+        header->info.freeFunc(header, header->info.userData);
+    } else {
+        free(header);
+    }
+}
+
+template <typename T>
+void copyVector(ImVector<T>& dst, const ImVector<T>& src) {
+    // unlike ImVector::operator=, resize doesn't free the old storage
+    dst.resize(src.Size);
+    if (src.Size > 0) {
+        memcpy(dst.Data, src.Data, src.Size * sizeof(T));
+    }
+}
+
+void copyDrawData(DrawDataSnapshot& snapshot, const ImDrawData* draw_data,
+                  const ImVec2& framebufferScale) {
+    ImVector<ImDrawList*>& lists = snapshot.lists;
+    while (lists.Size < draw_data->CmdListsCount) {
+        // only the buffers are used, the lists don't need ImGui's shared data
+        lists.push_back(IM_NEW(ImDrawList)(NULL));
+    }
+
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const ImDrawList* src = draw_data->CmdLists[n];
+        ImDrawList* dst = lists[n];
+        copyVector(dst->CmdBuffer, src->CmdBuffer);
+        copyVector(dst->IdxBuffer, src->IdxBuffer);
+        copyVector(dst->VtxBuffer, src->VtxBuffer);
+        dst->Flags = src->Flags;
+        dst->_OwnerName = src->_OwnerName;
+    }
+
+    snapshot.data = *draw_data;
+    snapshot.data.CmdLists = lists.Data;
+    snapshot.framebufferScale = framebufferScale;
+}
+
+void destroySnapshot(DrawDataSnapshot& snapshot) {
+    for (int n = 0; n < snapshot.lists.Size; ++n) {
+        IM_DELETE(snapshot.lists[n]);
+    }
+    snapshot.lists.clear();
+    snapshot.data = ImDrawData();
+}
+
+ImDrawData* endFrame(ImGui::SFML::ImGuiSFMLContext& context) {
+    setCurrentContext(context);
+    assert(context.imguiContext->IO.Fonts->TexID !=
+           (ImTextureID)NULL);  // You forgot to create and set font texture
+    assert(!context.sharedFontAtlas ||
+           context.sharedFontAtlas->thread == std::this_thread::get_id());
+
+    if (context.updateInterval == sf::Time::Zero) {
+        ProfileTimer timer(context, &FrameProfile::imguiRenderMs);
+        ImGui::Render();
+        resolveDynamicGlyphs(context, ImGui::GetDrawData());
+        if (context.captureFrames > 0) {
+            captureDrawData(context, ImGui::GetDrawData());
+        }
+        return ImGui::GetDrawData();
+    }
+
+    if (context.frameBuilt) {
+        ProfileTimer timer(context, &FrameProfile::imguiRenderMs);
+        ImGui::Render();
+        resolveDynamicGlyphs(context, ImGui::GetDrawData());
+        if (context.captureFrames > 0) {
+            captureDrawData(context, ImGui::GetDrawData());
+        }
+        copyDrawData(context.drawDataCopy, ImGui::GetDrawData(),
+                     context.imguiContext->IO.DisplayFramebufferScale);
+        context.frameBuilt = false;
+    }
+    // the copy is drawn even when the frame was just built, so callers only
+    // ever see one version of the data
+    return &context.drawDataCopy.data;
+}
+
+// custom rect ID of the dynamic region (IDs of regular rects are >= 0x110000)
+const unsigned int DYNAMIC_ATLAS_RECT_ID = 0x53464D4C;
+
+int findDynamicAtlasRect(const ImFontAtlas* fonts) {
+    for (int i = 0; i < fonts->CustomRects.Size; ++i) {
+        if (fonts->CustomRects[i].ID == DYNAMIC_ATLAS_RECT_ID) return i;
+    }
+    return -1;
+}
+
+void reserveDynamicAtlasRegion(ImGui::SFML::ImGuiSFMLContext& context) {
+    ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    if (findDynamicAtlasRect(fonts) != -1) {
+        return;
+    }
+    // the atlas is built again with the region, which can't be wider than it
+    fonts->ClearTexData();
+    if (fonts->TexDesiredWidth < context.dynamicAtlasWidth) {
+        fonts->TexDesiredWidth = context.dynamicAtlasWidth;
+    }
+    fonts->AddCustomRectRegular(DYNAMIC_ATLAS_RECT_ID, context.dynamicAtlasWidth,
+                                context.dynamicAtlasHeight);
+}
+
+void resetDynamicAtlas(ImGui::SFML::ImGuiSFMLContext& context) {
+    DynamicAtlas* atlas = context.dynamicAtlas;
+    if (!atlas) {
+        return;
+    }
+
+    const ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    int rect = findDynamicAtlasRect(fonts);
+    if (rect != -1 && fonts->CustomRects[rect].IsPacked()) {
+        atlas->regionX = fonts->CustomRects[rect].X;
+        atlas->regionY = fonts->CustomRects[rect].Y;
+        atlas->regionWidth = fonts->CustomRects[rect].Width;
+        atlas->regionHeight = fonts->CustomRects[rect].Height;
+    } else {
+        sf::err() << "ImGui-SFML: no room for the dynamic font region in the font atlas"
+                  << std::endl;
+        atlas->regionX = atlas->regionY = -1;
+        atlas->regionWidth = atlas->regionHeight = 0;
+    }
+
+    // the texture was just created: every cell is empty. The first row stays
+    // blank, for glyphs which don't get a cell.
+    atlas->cells.resize(0);
+    atlas->shelvesHeight = 1;
+    for (int i = 0; i < atlas->glyphs.Size; ++i) {
+        atlas->glyphs[i].cell = -1;
+    }
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    atlas->uploads.resize(0);
+    atlas->uploadPixels.resize(0);
+}
+
+// A free cell of the font's size: a free one, one in a new row, or the least
+// recently used one. Cells drawn in the last frames are kept, as snapshots
+// of these frames might still be rendered. Returns -1 if there's none.
+int allocateDynamicCell(DynamicAtlas& atlas, int fontIndex) {
+    const DynamicAtlas::Font& font = *atlas.fonts[fontIndex];
+    int leastRecent = -1;
+    for (int i = 0; i < atlas.cells.Size; ++i) {
+        const DynamicAtlas::Cell& cell = atlas.cells[i];
+        if (cell.font != fontIndex) continue;
+        if (cell.glyph == -1) return i;
+        if (cell.lastUsedFrame < atlas.frame - 2 &&
+            (leastRecent == -1 || cell.lastUsedFrame < atlas.cells[leastRecent].lastUsedFrame)) {
+            leastRecent = i;
+        }
+    }
+
+    if (atlas.shelvesHeight + font.cellHeight <= atlas.regionHeight &&
+        font.cellWidth <= atlas.regionWidth) {
+        int first = atlas.cells.Size;
+        for (int x = 0; x + font.cellWidth <= atlas.regionWidth; x += font.cellWidth) {
+            DynamicAtlas::Cell cell;
+            cell.x = x;
+            cell.y = atlas.shelvesHeight;
+            cell.font = fontIndex;
+            cell.glyph = -1;
+            cell.lastUsedFrame = 0;
+            atlas.cells.push_back(cell);
+        }
+        atlas.shelvesHeight += font.cellHeight;
+        return first;
+    }
+    return leastRecent;
+}
+
+void rasterizeDynamicGlyph(ImGui::SFML::ImGuiSFMLContext& context, int id) {
+    DynamicAtlas& atlas = *context.dynamicAtlas;
+    DynamicAtlas::Glyph& glyph = atlas.glyphs[id];
+    const DynamicAtlas::Font& font = *atlas.fonts[glyph.font];
+    int cellIndex = allocateDynamicCell(atlas, glyph.font);
+    if (cellIndex == -1) {
+        return;
+    }
+
+    DynamicAtlas::Cell& cell = atlas.cells[cellIndex];
+    if (cell.glyph != -1) {
+        atlas.glyphs[cell.glyph].cell = -1;  // evicted
+    }
+    cell.glyph = id;
+    glyph.cell = cellIndex;
+
+    // the whole cell is uploaded, which clears what the previous glyph left
+    DynamicAtlas::Upload upload;
+    upload.x = atlas.regionX + cell.x;
+    upload.y = atlas.regionY + cell.y;
+    upload.width = font.cellWidth;
+    upload.height = font.cellHeight;
+
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    upload.offset = atlas.uploadPixels.Size;
+    atlas.uploadPixels.resize(upload.offset + upload.width * upload.height);
+    unsigned char* pixels = atlas.uploadPixels.Data + upload.offset;
+    memset(pixels, 0, upload.width * upload.height);
+    stbtt_MakeGlyphBitmap(&font.info, pixels, glyph.width, glyph.height, upload.width,
+                          font.scale, font.scale, glyph.index);
+    atlas.uploads.push_back(upload);
+
+    // ImGui's copy of the atlas is used by the software renderer and GetFontTexture
+    ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    for (int y = 0; y < upload.height; ++y) {
+        const unsigned char* row = pixels + y * upload.width;
+        int atlasOffset = (upload.y + y) * fonts->TexWidth + upload.x;
+        if (fonts->TexPixelsAlpha8) {
+            memcpy(fonts->TexPixelsAlpha8 + atlasOffset, row, upload.width);
+        }
+        if (fonts->TexPixelsRGBA32) {
+            for (int x = 0; x < upload.width; ++x) {
+                fonts->TexPixelsRGBA32[atlasOffset + x] = IM_COL32(255, 255, 255, row[x]);
+            }
+        }
+    }
+    context.fontTextureStale = context.fontAtlasTexture != 0;
+}
+
+void resolveDynamicGlyphs(ImGui::SFML::ImGuiSFMLContext& context, ImDrawData* draw_data) {
+    DynamicAtlas* atlas = context.dynamicAtlas;
+    if (!atlas || atlas->glyphs.empty() || atlas->regionX < 0) {
+        return;
+    }
+    ++atlas->frame;
+
+    const ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    const ImVec2 uvScale = fonts->TexUvScale;
+    const ImVec2 blank((atlas->regionX + 0.5f) * uvScale.x, (atlas->regionY + 0.5f) * uvScale.y);
+
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const ImDrawIdx* idx_buffer = cmd_list->IdxBuffer.Data;
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; ++cmd_i) {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback || pcmd->TextureId != fonts->TexID) {
+                idx_buffer += pcmd->ElemCount;
+                continue;
+            }
+
+            ImDrawVert* vtx_buffer = cmd_list->VtxBuffer.Data;
+#if IMGUI_VERSION_NUM >= 17100
+            vtx_buffer += pcmd->VtxOffset;
+#endif
+            // vertices shared by several triangles are only rewritten the
+            // first time, their UVs are real ones afterwards
+            for (unsigned int i = 0; i < pcmd->ElemCount; ++i) {
+                ImVec2& uv = vtx_buffer[idx_buffer[i]].uv;
+                if (uv.x < DYNAMIC_GLYPH_U) continue;
+
+                float u = uv.x - DYNAMIC_GLYPH_U;
+                int id = (int)(u * 0.5f);
+                if (id >= atlas->glyphs.Size) continue;
+                float t = u - 2.0f * id;  // in [0, 1], partially clipped glyphs included
+
+                DynamicAtlas::Glyph& glyph = atlas->glyphs[id];
+                if (glyph.cell == -1 && glyph.width > 0 && glyph.height > 0) {
+                    rasterizeDynamicGlyph(context, id);
+                }
+                if (glyph.cell == -1) {
+                    uv = blank;
+                    continue;
+                }
+                DynamicAtlas::Cell& cell = atlas->cells[glyph.cell];
+                cell.lastUsedFrame = atlas->frame;
+                uv.x = (atlas->regionX + cell.x + t * glyph.width) * uvScale.x;
+                uv.y = (atlas->regionY + cell.y + uv.y * glyph.height) * uvScale.y;
+            }
+            idx_buffer += pcmd->ElemCount;
+        }
+    }
+}
+
+void uploadDynamicGlyphs(ImGui::SFML::ImGuiSFMLContext& context) {
+    DynamicAtlas* atlas = context.dynamicAtlas;
+    if (!atlas) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(context.snapshotMutex);
+    if (atlas->uploads.empty()) {
+        return;
+    }
+
+    if (context.fontAtlasTexture) {
+        // same format as uploadAlpha8FontTexture
+        GLenum format = context.renderer == ImGui::SFML::Renderer_Shader ? GL_RED : GL_ALPHA;
+        GLint lastTexture, lastAlignment;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &lastAlignment);
+        glBindTexture(GL_TEXTURE_2D, context.fontAtlasTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int i = 0; i < atlas->uploads.Size; ++i) {
+            const DynamicAtlas::Upload& upload = atlas->uploads[i];
+            glTexSubImage2D(GL_TEXTURE_2D, 0, upload.x, upload.y, upload.width, upload.height,
+                            format, GL_UNSIGNED_BYTE, atlas->uploadPixels.Data + upload.offset);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, lastAlignment);
+        glBindTexture(GL_TEXTURE_2D, lastTexture);
+    } else {
+        ImVector<sf::Uint8> rgba;
+        for (int i = 0; i < atlas->uploads.Size; ++i) {
+            const DynamicAtlas::Upload& upload = atlas->uploads[i];
+            const unsigned char* alpha = atlas->uploadPixels.Data + upload.offset;
+            rgba.resize(upload.width * upload.height * 4);
+            for (int p = 0; p < upload.width * upload.height; ++p) {
+                rgba[p * 4 + 0] = rgba[p * 4 + 1] = rgba[p * 4 + 2] = 255;
+                rgba[p * 4 + 3] = alpha[p];
+            }
+            context.fontTexture->update(rgba.Data, upload.width, upload.height, upload.x,
+                                        upload.y);
+        }
+    }
+    atlas->uploads.resize(0);
+    atlas->uploadPixels.resize(0);
+}
+
+void prepareRenderTarget(ImGui::SFML::ImGuiSFMLContext& context,
+                         sf::RenderTarget& target) {
+    if (context.minimalGLStateChanges) {
+        // RenderDrawLists puts back what it changes, but SFML's viewport is only
+        // known here: convert it to GL coordinates (origin at the bottom-left)
+        target.setActive(true);
+        sf::IntRect viewport = target.getViewport(target.getView());
+        context.targetViewport[0] = viewport.left;
+        context.targetViewport[1] =
+            static_cast<int>(target.getSize().y) - (viewport.top + viewport.height);
+        context.targetViewport[2] = viewport.width;
+        context.targetViewport[3] = viewport.height;
+
+        // ImGui blends with the factors of sf::BlendAlpha and leaves them set.
+        // SFML only calls glBlendFunc when its last blend mode changes, so a
+        // transparent point drawn with sf::BlendAlpha makes SFML's cache match.
+        sf::Vertex point(sf::Vector2f(0.f, 0.f), sf::Color::Transparent);
+        target.draw(&point, 1, sf::Points, sf::BlendAlpha);
+    } else {
+        target.resetGLStates();
+    }
+}
+
+// Mixes 8 bytes at a time, which is fast enough to run over all vertices
+// every frame. Not meant to resist anything but accidental collisions.
+void hashBytes(unsigned long long& hash, const void* data, std::size_t size) {
+    const unsigned long long multiplier = 0x9E3779B97F4A7C15ULL;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    unsigned long long h = hash;
+    for (; size >= 8; size -= 8, bytes += 8) {
+        unsigned long long word;
+        memcpy(&word, bytes, 8);
+        h = (h ^ word) * multiplier;
+        h ^= h >> 29;
+    }
+    if (size > 0) {
+        unsigned long long word = 0;
+        memcpy(&word, bytes, size);
+        h = (h ^ word) * multiplier;
+        h ^= h >> 29;
+    }
+    hash = h;
+}
+
+bool hashDrawData(const ImGuiIO& io, const ImDrawData* draw_data,
+                  unsigned long long& hash) {
+    unsigned long long h = 0xCBF29CE484222325ULL;
+    hashBytes(h, &io.DisplaySize, sizeof(io.DisplaySize));
+    hashBytes(h, &io.DisplayFramebufferScale, sizeof(io.DisplayFramebufferScale));
+    hashBytes(h, &draw_data->CmdListsCount, sizeof(draw_data->CmdListsCount));
 
     for (int n = 0; n < draw_data->CmdListsCount; ++n) {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        const unsigned char* vtx_buffer =
-            (const unsigned char*)&cmd_list->VtxBuffer.front();
-        const ImDrawIdx* idx_buffer = &cmd_list->IdxBuffer.front();
 
-        glVertexPointer(2, GL_FLOAT, sizeof(ImDrawVert),
-                        (void*)(vtx_buffer + offsetof(ImDrawVert, pos)));
-        glTexCoordPointer(2, GL_FLOAT, sizeof(ImDrawVert),
-                          (void*)(vtx_buffer + offsetof(ImDrawVert, uv)));
-        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ImDrawVert),
-                       (void*)(vtx_buffer + offsetof(ImDrawVert, col)));
+        // commands are hashed field by field: the struct has padding and
+        // callback data which don't matter here
+        hashBytes(h, &cmd_list->CmdBuffer.Size, sizeof(cmd_list->CmdBuffer.Size));
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; ++cmd_i) {
+            const ImDrawCmd& cmd = cmd_list->CmdBuffer[cmd_i];
+            if (cmd.UserCallback) {
+                return false;
+            }
+            hashBytes(h, &cmd.ElemCount, sizeof(cmd.ElemCount));
+            hashBytes(h, &cmd.ClipRect, sizeof(cmd.ClipRect));
+            hashBytes(h, &cmd.TextureId, sizeof(cmd.TextureId));
+#if IMGUI_VERSION_NUM >= 17100
+            hashBytes(h, &cmd.VtxOffset, sizeof(cmd.VtxOffset));
+#endif
+        }
+
+        hashBytes(h, &cmd_list->VtxBuffer.Size, sizeof(cmd_list->VtxBuffer.Size));
+        hashBytes(h, cmd_list->VtxBuffer.Data,
+                  cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+        hashBytes(h, &cmd_list->IdxBuffer.Size, sizeof(cmd_list->IdxBuffer.Size));
+        hashBytes(h, cmd_list->IdxBuffer.Data,
+                  cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+    }
+
+    hash = h;
+    return true;
+}
+
+bool renderCachedDrawData(ImGui::SFML::ImGuiSFMLContext& context,
+                          sf::RenderTarget& target, ImDrawData* draw_data) {
+    const ImGuiIO& io = context.imguiContext->IO;
+    unsigned int fb_width =
+        static_cast<unsigned int>(io.DisplaySize.x * io.DisplayFramebufferScale.x);
+    unsigned int fb_height =
+        static_cast<unsigned int>(io.DisplaySize.y * io.DisplayFramebufferScale.y);
+    if (fb_width == 0 || fb_height == 0 || draw_data->CmdListsCount == 0) {
+        return false;  // nothing to cache, RenderDrawLists returns early
+    }
+
+    unsigned long long hash;
+    if (!hashDrawData(io, draw_data, hash)) {
+        return false;
+    }
+
+    if (!context.renderCache) {
+        context.renderCache = IM_NEW(sf::RenderTexture);
+        context.renderCacheValid = false;
+    }
+    sf::RenderTexture& cache = *context.renderCache;
+    if (cache.getSize().x != fb_width || cache.getSize().y != fb_height) {
+        context.renderCacheValid = false;
+        if (!cache.create(fb_width, fb_height)) {
+            sf::err() << "ImGui-SFML: can't create the render cache texture, "
+                         "drawing directly"
+                      << std::endl;
+            IM_DELETE(context.renderCache);
+            context.renderCache = NULL;
+            context.cacheRendering = false;
+            return false;
+        }
+    }
+
+    if (!context.renderCacheValid || hash != context.renderCacheHash) {
+        cache.clear(sf::Color::Transparent);
+        prepareRenderTarget(context, cache);
+        RenderDrawLists(context, draw_data, io.DisplayFramebufferScale);
+        cache.display();
+
+        context.renderCacheHash = hash;
+        context.renderCacheValid = true;
+    } else {
+        context.renderStats = ImGui::SFML::ImGuiSFMLContext::RenderStats();
+        context.renderStats.fromRenderCache = true;
+    }
+
+    // the cache holds premultiplied colors (transparent background blended
+    // with separate alpha factors). Map it like RenderDrawLists maps ImGui's
+    // coordinates: display size over the whole target.
+    sf::Sprite sprite(cache.getTexture());
+    sprite.setScale(1.f / io.DisplayFramebufferScale.x,
+                    1.f / io.DisplayFramebufferScale.y);
+    sf::View previousView = target.getView();
+    target.setView(sf::View(sf::FloatRect(0.f, 0.f, io.DisplaySize.x, io.DisplaySize.y)));
+    target.draw(sprite, sf::RenderStates(sf::BlendMode(sf::BlendMode::One,
+                                                       sf::BlendMode::OneMinusSrcAlpha)));
+    target.setView(previousView);
+    return true;
+}
+
+bool imageButtonImpl(const sf::Texture& texture,
+                     const sf::FloatRect& textureRect, const sf::Vector2f& size,
+                     const int framePadding, const sf::Color& bgColor,
+                     const sf::Color& tintColor) {
+    ImVec2 uv0, uv1;
+    ImTextureID textureID = getTextureIDForCurrentContext(texture, textureRect, uv0, uv1);
+    return ImGui::ImageButton(textureID, ImVec2(size.x,size.y), uv0, uv1, framePadding, toImColor(bgColor),
+        toImColor(tintColor));
+}
+
+unsigned int getConnectedJoystickId() {
+    for (unsigned int i = 0; i < (unsigned int)sf::Joystick::Count; ++i) {
+        if (sf::Joystick::isConnected(i)) return i;
+    }
+
+    return ImGui::SFML::NULL_JOYSTICK_ID;
+}
+
+void initDefaultJoystickMapping(ImGui::SFML::ImGuiSFMLContext& context) {
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Activate, 0);
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Cancel, 1);
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Input, 3);
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Menu, 2);
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_FocusPrev, 4);
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_FocusNext, 5);
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_TweakSlow, 4);
+    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_TweakFast, 5);
+
+    ImGui::SFML::SetDPadXAxis(context, sf::Joystick::PovX);
+    // D-pad Y axis is inverted on Windows
+#ifdef _WIN32
+    ImGui::SFML::SetDPadYAxis(context, sf::Joystick::PovY, true);
+#else
+    ImGui::SFML::SetDPadYAxis(context, sf::Joystick::PovY);
+#endif
+
+    ImGui::SFML::SetLStickXAxis(context, sf::Joystick::X);
+    ImGui::SFML::SetLStickYAxis(context, sf::Joystick::Y);
+
+    ImGui::SFML::SetJoytickDPadThreshold(context, 5.f);
+    ImGui::SFML::SetJoytickLStickThreshold(context, 5.f);
+}
+
+bool isJoystickButtonPressed(ImGui::SFML::ImGuiSFMLContext& context, unsigned int button) {
+    if (button >= sf::Joystick::ButtonCount) {
+        return false;
+    }
+    if (context.pollInputDevices) {
+        countInputQueries(context, 1);
+        return sf::Joystick::isButtonPressed(context.joystickId, button);
+    }
+    return context.joystickButtons[button];
+}
+
+float getJoystickAxisPosition(ImGui::SFML::ImGuiSFMLContext& context, sf::Joystick::Axis axis) {
+    if (context.pollInputDevices) {
+        countInputQueries(context, 1);
+        return sf::Joystick::getAxisPosition(context.joystickId, axis);
+    }
+    return context.joystickAxes[axis];
+}
+
+void setActiveJoystick(ImGui::SFML::ImGuiSFMLContext& context, unsigned int joystickId) {
+    if (joystickId == context.joystickId) {
+        return;
+    }
+    // events of the new joystick tell its state from now on
+    context.joystickId = joystickId;
+    for (unsigned int i = 0; i < sf::Joystick::ButtonCount; ++i) {
+        context.joystickButtons[i] = false;
+    }
+    for (unsigned int i = 0; i < sf::Joystick::AxisCount; ++i) {
+        context.joystickAxes[i] = 0.f;
+    }
+}
+
+void countInputQueries(ImGui::SFML::ImGuiSFMLContext& context, unsigned int count) {
+    context.inputStats.frameQueries += count;
+    context.inputStats.totalQueries += count;
+}
+
+sf::Vector2i getWindowMousePosition(ImGui::SFML::ImGuiSFMLContext& context, const sf::Window& window) {
+    if (context.mouseMoved) {
+        if (!context.pollInputDevices) {
+            return context.mousePosition;
+        }
+        countInputQueries(context, 1);
+        return sf::Mouse::getPosition(window);
+    }
+    if (context.pollInputDevices) {
+        countInputQueries(context, 1);
+        if (sf::Touch::isDown(0)) {
+            context.touchPos = sf::Touch::getPosition(0, window);
+            countInputQueries(context, 1);
+        }
+    }
+    return context.touchPos;
+}
+
+void updateJoystickActionState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io, ImGuiNavInput_ action) {
+    bool isPressed = isJoystickButtonPressed(context, context.joystickMapping[action]);
+    io.NavInputs[action] = isPressed ? 1.0f : 0.0f;
+}
+
+void updateJoystickDPadState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io) {
+    float dpadXPos =
+        getJoystickAxisPosition(context, context.dPadInfo.xAxis);
+    if (context.dPadInfo.xInverted) dpadXPos = -dpadXPos;
+
+    float dpadYPos =
+        getJoystickAxisPosition(context, context.dPadInfo.yAxis);
+    if (context.dPadInfo.yInverted) dpadYPos = -dpadYPos;
+
+    io.NavInputs[ImGuiNavInput_DpadLeft] =
+        dpadXPos < -context.dPadInfo.threshold ? 1.0f : 0.0f;
+    io.NavInputs[ImGuiNavInput_DpadRight] =
+        dpadXPos > context.dPadInfo.threshold ? 1.0f : 0.0f;
+
+    io.NavInputs[ImGuiNavInput_DpadUp] =
+        dpadYPos < -context.dPadInfo.threshold ? 1.0f : 0.0f;
+    io.NavInputs[ImGuiNavInput_DpadDown] =
+        dpadYPos > context.dPadInfo.threshold ? 1.0f : 0.0f;
+}
+
+void updateJoystickLStickState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io) {
+    float lStickXPos =
+        getJoystickAxisPosition(context, context.lStickInfo.xAxis);
+    if (context.lStickInfo.xInverted) lStickXPos = -lStickXPos;
+
+    float lStickYPos =
+        getJoystickAxisPosition(context, context.lStickInfo.yAxis);
+    if (context.lStickInfo.yInverted) lStickYPos = -lStickYPos;
+
+    if (lStickXPos < -context.lStickInfo.threshold) {
+        io.NavInputs[ImGuiNavInput_LStickLeft] = std::abs(lStickXPos / 100.f);
+    }
+
+    if (lStickXPos > context.lStickInfo.threshold) {
+        io.NavInputs[ImGuiNavInput_LStickRight] = lStickXPos / 100.f;
+    }
+
+    if (lStickYPos < -context.lStickInfo.threshold) {
+        io.NavInputs[ImGuiNavInput_LStickUp] = std::abs(lStickYPos / 100.f);
+    }
+
+    if (lStickYPos > context.lStickInfo.threshold) {
+        io.NavInputs[ImGuiNavInput_LStickDown] = lStickYPos / 100.f;
+    }
+}
+
+bool applyEvent(ImGui::SFML::ImGuiSFMLContext& context, const sf::Event& event) {
+    setCurrentContext(context);  // input characters may grow ImGui's queue
+    bool relevant = false;
+    if (context.windowHasFocus) {
+        ImGuiIO& io = context.imguiContext->IO;
+
+        relevant = true;
+        switch (event.type) {
+            case sf::Event::MouseButtonPressed:  // fall-through
+            case sf::Event::MouseButtonReleased: {
+                int button = event.mouseButton.button;
+                if (event.type == sf::Event::MouseButtonPressed &&
+                    button >= 0 && button < 3) {
+                    context.mousePressed[event.mouseButton.button] = true;
+                    context.mouseHeld[event.mouseButton.button] = true;
+                }
+            } break;
+            case sf::Event::TouchBegan:  // fall-through
+            case sf::Event::TouchMoved:
+            case sf::Event::TouchEnded: {
+                context.mouseMoved = false;
+                int button = event.touch.finger;
+                if (button == 0 && event.type != sf::Event::TouchEnded) {
+                    context.touchPos = sf::Vector2i(event.touch.x, event.touch.y);
+                }
+                if (event.type == sf::Event::TouchBegan && button >= 0 &&
+                    button < 3) {
+                    context.touchDown[event.touch.finger] = true;
+                    context.touchHeld[event.touch.finger] = true;
+                }
+            } break;
+            case sf::Event::MouseWheelScrolled:
+                if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel ||
+                    (event.mouseWheelScroll.wheel == sf::Mouse::HorizontalWheel &&
+                    io.KeyShift)) {
+                    io.MouseWheel += event.mouseWheelScroll.delta;
+                } else if (event.mouseWheelScroll.wheel == sf::Mouse::HorizontalWheel) {
+                    io.MouseWheelH += event.mouseWheelScroll.delta;
+                }
+                break;
+            case sf::Event::KeyPressed:  // fall-through
+            case sf::Event::KeyReleased:
+                io.KeysDown[event.key.code] =
+                    (event.type == sf::Event::KeyPressed);
+                break;
+            case sf::Event::TextEntered:
+                // Don't handle the event for unprintable characters
+                if (event.text.unicode < ' ' || event.text.unicode == 127) {
+                    relevant = false;
+                    break;
+                }
+                io.AddInputCharacter(event.text.unicode);
+                break;
+            case sf::Event::JoystickConnected:
+                if (context.joystickId == ImGui::SFML::NULL_JOYSTICK_ID) {
+                    setActiveJoystick(context, event.joystickConnect.joystickId);
+                }
+                break;
+            case sf::Event::JoystickDisconnected:
+                if (context.joystickId ==
+                    event.joystickConnect
+                        .joystickId) {  // used gamepad was disconnected
+                    setActiveJoystick(context, getConnectedJoystickId());
+                }
+                break;
+            case sf::Event::Closed:  // fall-through
+            case sf::Event::Resized:
+            case sf::Event::MouseMoved:
+            case sf::Event::MouseEntered:
+            case sf::Event::MouseLeft:
+            case sf::Event::JoystickButtonPressed:
+            case sf::Event::JoystickButtonReleased:
+            case sf::Event::JoystickMoved:
+                break;
+            default:
+                relevant = false;
+                break;
+        }
+    }
+
+    // the mouse position, releases and joystick state are tracked without focus
+    // too, or buttons released in another window would stay held and a click
+    // which gives the focus back would be at a stale position
+    switch (event.type) {
+        case sf::Event::MouseMoved:
+            context.mouseMoved = true;
+            context.mousePosition = sf::Vector2i(event.mouseMove.x, event.mouseMove.y);
+            break;
+        case sf::Event::MouseLeft:
+            // nothing stays hovered, but a drag keeps its last position
+            if (!context.mouseHeld[0] && !context.mouseHeld[1] && !context.mouseHeld[2]) {
+                context.mousePosition = ImGui::SFML::MOUSE_OUTSIDE;
+            }
+            break;
+        case sf::Event::MouseButtonPressed:  // fall-through
+        case sf::Event::MouseButtonReleased:
+            context.mousePosition = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+            if (event.type == sf::Event::MouseButtonReleased &&
+                event.mouseButton.button >= 0 && event.mouseButton.button < 3) {
+                context.mouseHeld[event.mouseButton.button] = false;
+            }
+            break;
+        case sf::Event::TouchEnded:
+            if (event.touch.finger < 3) {
+                context.touchHeld[event.touch.finger] = false;
+            }
+            break;
+        case sf::Event::JoystickButtonPressed:  // fall-through
+        case sf::Event::JoystickButtonReleased:
+            if (event.joystickButton.joystickId == context.joystickId &&
+                event.joystickButton.button < sf::Joystick::ButtonCount) {
+                context.joystickButtons[event.joystickButton.button] =
+                    (event.type == sf::Event::JoystickButtonPressed);
+            }
+            break;
+        case sf::Event::JoystickMoved:
+            if (event.joystickMove.joystickId == context.joystickId) {
+                context.joystickAxes[event.joystickMove.axis] = event.joystickMove.position;
+            }
+            break;
+        default:
+            break;
+    }
+
+    switch (event.type) {
+        case sf::Event::LostFocus:
+            context.windowHasFocus = false;
+            relevant = true;
+            break;
+        case sf::Event::GainedFocus:
+            context.windowHasFocus = true;
+            relevant = true;
+            break;
+        case sf::Event::Resized:
+            relevant = true;
+            break;
+        default:
+            break;
+    }
+
+    if (relevant) {
+        // ImGui reacts to some input over a couple of frames (hover state,
+        // layout of windows which just appeared...)
+        context.framesPending = ImGui::SFML::IDLE_SETTLE_FRAMES;
+    }
+    return relevant;
+}
+
+void applyQueuedEvents(ImGui::SFML::ImGuiSFMLContext& context) {
+    InputQueue& queue = *context.inputQueue;
+    const ImGuiIO& io = context.imguiContext->IO;
+    bool keysChanged[sf::Keyboard::KeyCount] = {};
+    bool buttonsChanged[3] = {};  // mouse buttons and touch fingers
+    bool clicked = false;
+    sf::Int64 now = queue.clock.getElapsedTime().asMicroseconds();
+    sf::Int64 maxLatency = 0;
+    unsigned int mask = (unsigned int)queue.entries.Size - 1;
+    unsigned int head = queue.head.load(std::memory_order_relaxed);
+    unsigned int tail = queue.tail.load(std::memory_order_acquire);
+    unsigned int applied = 0;
+
+    for (; head != tail; ++head) {
+        const InputQueue::Entry& entry = queue.entries[head & mask];
+        const sf::Event& event = entry.event;
+        int button = -1;
+        bool holdBack = false;
+        switch (event.type) {
+            case sf::Event::KeyPressed:  // fall-through
+            case sf::Event::KeyReleased:
+                // auto-repeats of a held key, and keys without focus, change nothing
+                if (event.key.code >= 0 && event.key.code < sf::Keyboard::KeyCount &&
+                    context.windowHasFocus &&
+                    io.KeysDown[event.key.code] != (event.type == sf::Event::KeyPressed)) {
+                    holdBack = keysChanged[event.key.code];
+                    keysChanged[event.key.code] = true;
+                }
+                break;
+            case sf::Event::MouseButtonPressed:  // fall-through
+            case sf::Event::MouseButtonReleased:
+                button = event.mouseButton.button;
+                break;
+            case sf::Event::TouchBegan:  // fall-through
+            case sf::Event::TouchEnded:
+                button = (int)event.touch.finger;
+                break;
+            case sf::Event::MouseMoved:  // fall-through
+            case sf::Event::TouchMoved:
+                // ImGui only sees the last position of a frame: a click is where it happened
+                holdBack = clicked;
+                break;
+            default:
+                break;
+        }
+        if (button >= 0 && button < 3) {
+            holdBack = buttonsChanged[button];
+            buttonsChanged[button] = true;
+            clicked = true;
+        }
+        if (holdBack) {
+            break;
+        }
+
+        applyEvent(context, event);
+        maxLatency = std::max(maxLatency, now - entry.time);
+        ++applied;
+    }
+    queue.head.store(head, std::memory_order_release);
 
-        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.size(); ++cmd_i) {
-            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
-            if (pcmd->UserCallback) {
-                pcmd->UserCallback(cmd_list, pcmd);
-            } else {
-                GLuint textureHandle =
-                    convertImTextureIDToGLTextureHandle(pcmd->TextureId);
-                glBindTexture(GL_TEXTURE_2D, textureHandle);
-                glScissor((int)pcmd->ClipRect.x,
-                          (int)(fb_height - pcmd->ClipRect.w),
-                          (int)(pcmd->ClipRect.z - pcmd->ClipRect.x),
-                          (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-                glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount,
-                               GL_UNSIGNED_SHORT, idx_buffer);
-            }
-            idx_buffer += pcmd->ElemCount;
+    context.inputQueueStats.appliedEvents = applied;
+    context.inputQueueStats.heldBackEvents = tail - head;
+    context.inputQueueStats.maxLatency = sf::microseconds(maxLatency);
+    context.inputQueueStats.droppedEvents = queue.dropped.load(std::memory_order_relaxed);
+}
+
+bool getIdleTimeout(ImGui::SFML::ImGuiSFMLContext& context, sf::Time& timeout) {
+    const ImGuiIO& io = context.imguiContext->IO;
+    timeout = sf::Time::Zero;
+    if (context.framesPending > 0) {
+        return true;
+    }
+
+    // events which were queued or held back by the last frame
+    if (context.inputQueue && context.inputQueue->head.load(std::memory_order_acquire) !=
+                                  context.inputQueue->tail.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    // held buttons repeat and drag, even when the mouse doesn't move
+    for (int i = 0; i < 3; ++i) {
+        if (io.MouseDown[i]) {
+            return true;
         }
     }
-#ifdef GL_VERSION_ES_CL_1_1
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    glDisable(GL_SCISSOR_TEST);
+
+    // the text cursor blinks with a 1.2 s period, visible for the first 0.8 s.
+    // Redrawing every 0.4 s catches both edges closely enough.
+    if (io.WantTextInput && io.ConfigInputTextCursorBlink) {
+        sf::Time blinkInterval = sf::seconds(0.4f);
+        sf::Time elapsed = context.idleClock.getElapsedTime();
+        timeout = elapsed < blinkInterval ? blinkInterval - elapsed : sf::Time::Zero;
+        return true;
+    }
+
+    return false;
+}
+
+void setClipboardText(void* userData, const char* text) {
+    sf::Clipboard::setString(sf::String::fromUtf8(text, text + std::strlen(text)));
+}
+
+const char* getClipboadText(void* userData) {
+    ImGui::SFML::ImGuiSFMLContext* contextPtr = (ImGui::SFML::ImGuiSFMLContext*)userData;
+    sf::String text = sf::Clipboard::getString();
+    // converted in place, clipboardText keeps its capacity between pastes
+    contextPtr->clipboardText.clear();
+    sf::Utf<32>::toUtf8(text.begin(), text.end(),
+                        std::back_inserter(contextPtr->clipboardText));
+    return contextPtr->clipboardText.c_str();
+}
+
+// Read-only mapping of a whole file
+struct MappedFile {
+    const unsigned char* data;
+    std::size_t size;
+#ifdef _WIN32
+    HANDLE file, mapping;
 #else
-    glPopAttrib();
+    int fd;
+#endif
+};
+
+bool mapFile(const char* path, MappedFile& mapped) {
+    mapped.data = NULL;
+    mapped.size = 0;
+#ifdef _WIN32
+    mapped.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mapped.file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    mapped.mapping = NULL;
+    if (GetFileSizeEx(mapped.file, &size) && size.QuadPart > 0) {
+        mapped.mapping = CreateFileMappingA(mapped.file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    if (mapped.mapping) {
+        mapped.data = (const unsigned char*)MapViewOfFile(mapped.mapping, FILE_MAP_READ, 0, 0, 0);
+        mapped.size = (std::size_t)size.QuadPart;
+    }
+    if (!mapped.data) {
+        if (mapped.mapping) CloseHandle(mapped.mapping);
+        CloseHandle(mapped.file);
+        return false;
+    }
+#else
+    mapped.fd = open(path, O_RDONLY);
+    if (mapped.fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(mapped.fd, &info) != 0 || info.st_size <= 0) {
+        close(mapped.fd);
+        return false;
+    }
+    void* data = mmap(NULL, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, mapped.fd, 0);
+    if (data == MAP_FAILED) {
+        close(mapped.fd);
+        return false;
+    }
+    mapped.data = (const unsigned char*)data;
+    mapped.size = (std::size_t)info.st_size;
 #endif
+    return true;
 }
 
-bool imageButtonImpl(const sf::Texture& texture,
-                     const sf::FloatRect& textureRect, const sf::Vector2f& size,
-                     const int framePadding, const sf::Color& bgColor,
-                     const sf::Color& tintColor) {
-    sf::Vector2f textureSize = static_cast<sf::Vector2f>(texture.getSize());
+void unmapFile(MappedFile& mapped) {
+#ifdef _WIN32
+    UnmapViewOfFile(mapped.data);
+    CloseHandle(mapped.mapping);
+    CloseHandle(mapped.file);
+#else
+    munmap((void*)mapped.data, mapped.size);
+    close(mapped.fd);
+#endif
+    mapped.data = NULL;
+    mapped.size = 0;
+}
 
-    ImVec2 uv0(textureRect.left / textureSize.x,
-               textureRect.top / textureSize.y);
-    ImVec2 uv1((textureRect.left + textureRect.width) / textureSize.x,
-               (textureRect.top + textureRect.height) / textureSize.y);
+// Layout of the font atlas cache file, in the native byte order (the key
+// covers it): header, fonts, glyphs of each font, custom rects, alpha8 pixels
+const char FONT_ATLAS_CACHE_MAGIC[8] = {'I', 'S', 'F', 'M', 'L', 'F', 'A', '1'};
+
+struct FontAtlasCacheHeader {
+    char magic[8];
+    unsigned long long key;
+    int texWidth, texHeight;
+    float texUvScale[2], texUvWhitePixel[2];  // ImVec2 has a constructor
+    int fontCount;
+    int customRectCount;
+    int customRectIds[1];
+};
+
+struct FontAtlasCacheFont {
+    float fontSize, ascent, descent;
+    int metricsTotalSurface;
+    int glyphCount;
+};
+
+struct FontAtlasCacheRect {
+    unsigned int id;
+    unsigned short width, height, x, y;
+    float glyphAdvanceX;
+    float glyphOffset[2];
+    int font;  // index in Fonts, -1 if none
+};
+
+int findFontIndex(const ImFontAtlas* fonts, const ImFont* font) {
+    for (int i = 0; i < fonts->Fonts.Size; ++i) {
+        if (fonts->Fonts[i] == font) return i;
+    }
+    return -1;
+}
 
-    ImTextureID textureID =
-        convertGLTextureHandleToImTextureID(texture.getNativeHandle());
-    return ImGui::ImageButton(textureID, ImVec2(size.x,size.y), uv0, uv1, framePadding, toImColor(bgColor),
-        toImColor(tintColor));
+// Everything Build reads: font data and configs, atlas settings and custom
+// rects, plus what the file layout depends on
+unsigned long long fontAtlasCacheKey(const ImFontAtlas* fonts) {
+    unsigned long long h = 0xCBF29CE484222325ULL;
+    int layout[5] = {IMGUI_VERSION_NUM, (int)sizeof(ImFontGlyph), (int)sizeof(ImWchar),
+                     (int)sizeof(FontAtlasCacheHeader), 0x01020304};
+    hashBytes(h, layout, sizeof(layout));
+    hashBytes(h, &fonts->Flags, sizeof(fonts->Flags));
+    hashBytes(h, &fonts->TexDesiredWidth, sizeof(fonts->TexDesiredWidth));
+    hashBytes(h, &fonts->TexGlyphPadding, sizeof(fonts->TexGlyphPadding));
+    hashBytes(h, &fonts->Fonts.Size, sizeof(fonts->Fonts.Size));
+
+    for (int i = 0; i < fonts->ConfigData.Size; ++i) {
+        const ImFontConfig& cfg = fonts->ConfigData[i];
+        hashBytes(h, cfg.FontData, cfg.FontDataSize);
+        hashBytes(h, &cfg.FontNo, sizeof(cfg.FontNo));
+        hashBytes(h, &cfg.SizePixels, sizeof(cfg.SizePixels));
+        hashBytes(h, &cfg.OversampleH, sizeof(cfg.OversampleH));
+        hashBytes(h, &cfg.OversampleV, sizeof(cfg.OversampleV));
+        hashBytes(h, &cfg.PixelSnapH, sizeof(cfg.PixelSnapH));
+        hashBytes(h, &cfg.GlyphExtraSpacing, sizeof(cfg.GlyphExtraSpacing));
+        hashBytes(h, &cfg.GlyphOffset, sizeof(cfg.GlyphOffset));
+        hashBytes(h, &cfg.GlyphMinAdvanceX, sizeof(cfg.GlyphMinAdvanceX));
+        hashBytes(h, &cfg.GlyphMaxAdvanceX, sizeof(cfg.GlyphMaxAdvanceX));
+        hashBytes(h, &cfg.MergeMode, sizeof(cfg.MergeMode));
+        hashBytes(h, &cfg.RasterizerFlags, sizeof(cfg.RasterizerFlags));
+        hashBytes(h, &cfg.RasterizerMultiply, sizeof(cfg.RasterizerMultiply));
+        int dstFont = findFontIndex(fonts, cfg.DstFont);
+        hashBytes(h, &dstFont, sizeof(dstFont));
+
+        int rangeCount = 0;
+        if (cfg.GlyphRanges) {
+            while (cfg.GlyphRanges[rangeCount]) ++rangeCount;
+            hashBytes(h, cfg.GlyphRanges, rangeCount * sizeof(ImWchar));
+        }
+        hashBytes(h, &rangeCount, sizeof(rangeCount));
+    }
+
+    for (int i = 0; i < fonts->CustomRects.Size; ++i) {
+        const ImFontAtlas::CustomRect& rect = fonts->CustomRects[i];
+        hashBytes(h, &rect.ID, sizeof(rect.ID));
+        hashBytes(h, &rect.Width, sizeof(rect.Width));
+        hashBytes(h, &rect.Height, sizeof(rect.Height));
+        hashBytes(h, &rect.GlyphAdvanceX, sizeof(rect.GlyphAdvanceX));
+        hashBytes(h, &rect.GlyphOffset, sizeof(rect.GlyphOffset));
+        int font = findFontIndex(fonts, rect.Font);
+        hashBytes(h, &font, sizeof(font));
+    }
+    hashBytes(h, &fonts->CustomRects.Size, sizeof(fonts->CustomRects.Size));
+    return h;
 }
 
-unsigned int getConnectedJoystickId() {
-    for (unsigned int i = 0; i < (unsigned int)sf::Joystick::Count; ++i) {
-        if (sf::Joystick::isConnected(i)) return i;
+// Checks the sizes in the mapped file before anything is read from it
+bool loadFontAtlasCache(ImFontAtlas* fonts, unsigned long long key, const MappedFile& file) {
+    const unsigned char* data = file.data;
+    const unsigned char* end = file.data + file.size;
+
+    FontAtlasCacheHeader header;
+    if (file.size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    data += sizeof(header);
+    if (memcmp(header.magic, FONT_ATLAS_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.key != key || header.fontCount != fonts->Fonts.Size ||
+        header.customRectCount < 0 || header.texWidth <= 0 || header.texHeight <= 0) {
+        return false;
     }
 
-    return ImGui::SFML::NULL_JOYSTICK_ID;
+    const unsigned char* fontData = data;
+    std::size_t glyphBytes = 0;
+    for (int i = 0; i < header.fontCount; ++i) {
+        if ((std::size_t)(end - data) < sizeof(FontAtlasCacheFont)) return false;
+        FontAtlasCacheFont font;
+        memcpy(&font, data, sizeof(font));
+        data += sizeof(font);
+        if (font.glyphCount < 0) return false;
+        glyphBytes += font.glyphCount * sizeof(ImFontGlyph);
+    }
+    std::size_t pixelBytes = (std::size_t)header.texWidth * header.texHeight;
+    if ((std::size_t)(end - data) !=
+        glyphBytes + header.customRectCount * sizeof(FontAtlasCacheRect) + pixelBytes) {
+        return false;
+    }
+
+    // same output as ImFontAtlasBuildSetupFont, AddGlyph and ImFontAtlasBuildFinish
+    for (int i = 0; i < fonts->Fonts.Size; ++i) {
+        fonts->Fonts[i]->ClearOutputData();
+    }
+    for (int i = 0; i < fonts->ConfigData.Size; ++i) {
+        ImFontConfig& cfg = fonts->ConfigData[i];
+        ImFont* font = cfg.DstFont;
+        if (!cfg.MergeMode) {
+            font->ConfigData = &cfg;
+            font->ContainerAtlas = fonts;
+        }
+        font->ConfigDataCount++;
+    }
+    for (int i = 0; i < fonts->Fonts.Size; ++i) {
+        FontAtlasCacheFont cached;
+        memcpy(&cached, fontData + i * sizeof(cached), sizeof(cached));
+        ImFont* font = fonts->Fonts[i];
+        font->FontSize = cached.fontSize;
+        font->Ascent = cached.ascent;
+        font->Descent = cached.descent;
+        font->MetricsTotalSurface = cached.metricsTotalSurface;
+        font->Glyphs.resize(cached.glyphCount);
+        if (cached.glyphCount > 0) {
+            memcpy(font->Glyphs.Data, data, cached.glyphCount * sizeof(ImFontGlyph));
+        }
+        data += cached.glyphCount * sizeof(ImFontGlyph);
+    }
+
+    fonts->CustomRects.resize(header.customRectCount);
+    for (int i = 0; i < header.customRectCount; ++i) {
+        FontAtlasCacheRect cached;
+        memcpy(&cached, data, sizeof(cached));
+        data += sizeof(cached);
+        ImFontAtlas::CustomRect& rect = fonts->CustomRects[i];
+        rect.ID = cached.id;
+        rect.Width = cached.width;
+        rect.Height = cached.height;
+        rect.X = cached.x;
+        rect.Y = cached.y;
+        rect.GlyphAdvanceX = cached.glyphAdvanceX;
+        rect.GlyphOffset = ImVec2(cached.glyphOffset[0], cached.glyphOffset[1]);
+        rect.Font = cached.font >= 0 && cached.font < fonts->Fonts.Size
+                        ? fonts->Fonts[cached.font]
+                        : NULL;
+    }
+    fonts->CustomRectIds[0] = header.customRectIds[0];
+
+    // ImGui owns (and frees) its pixels, they're copied out of the mapping
+    fonts->ClearTexData();
+    fonts->TexWidth = header.texWidth;
+    fonts->TexHeight = header.texHeight;
+    fonts->TexUvScale = ImVec2(header.texUvScale[0], header.texUvScale[1]);
+    fonts->TexUvWhitePixel = ImVec2(header.texUvWhitePixel[0], header.texUvWhitePixel[1]);
+    fonts->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(pixelBytes);
+    memcpy(fonts->TexPixelsAlpha8, data, pixelBytes);
+
+    for (int i = 0; i < fonts->Fonts.Size; ++i) {
+        fonts->Fonts[i]->BuildLookupTable();
+    }
+    return true;
 }
 
-void initDefaultJoystickMapping(ImGui::SFML::ImGuiSFMLContext& context) {
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Activate, 0);
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Cancel, 1);
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Input, 3);
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_Menu, 2);
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_FocusPrev, 4);
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_FocusNext, 5);
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_TweakSlow, 4);
-    ImGui::SFML::SetJoystickMapping(context, ImGuiNavInput_TweakFast, 5);
+bool writeFontAtlasCache(const ImFontAtlas* fonts, unsigned long long key,
+                         const std::string& path) {
+    // written next to the cache and renamed, so that readers never see half a file
+    std::string tempPath = path + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
 
-    ImGui::SFML::SetDPadXAxis(context, sf::Joystick::PovX);
-    // D-pad Y axis is inverted on Windows
-#ifdef _WIN32
-    ImGui::SFML::SetDPadYAxis(context, sf::Joystick::PovY, true);
-#else
-    ImGui::SFML::SetDPadYAxis(sf::Joystick::PovY);
-#endif
+    FontAtlasCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FONT_ATLAS_CACHE_MAGIC, sizeof(header.magic));
+    header.key = key;
+    header.texWidth = fonts->TexWidth;
+    header.texHeight = fonts->TexHeight;
+    header.texUvScale[0] = fonts->TexUvScale.x;
+    header.texUvScale[1] = fonts->TexUvScale.y;
+    header.texUvWhitePixel[0] = fonts->TexUvWhitePixel.x;
+    header.texUvWhitePixel[1] = fonts->TexUvWhitePixel.y;
+    header.fontCount = fonts->Fonts.Size;
+    header.customRectCount = fonts->CustomRects.Size;
+    header.customRectIds[0] = fonts->CustomRectIds[0];
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (int i = 0; ok && i < fonts->Fonts.Size; ++i) {
+        const ImFont* font = fonts->Fonts[i];
+        FontAtlasCacheFont cached;
+        memset(&cached, 0, sizeof(cached));
+        cached.fontSize = font->FontSize;
+        cached.ascent = font->Ascent;
+        cached.descent = font->Descent;
+        cached.metricsTotalSurface = font->MetricsTotalSurface;
+        cached.glyphCount = font->Glyphs.Size;
+        ok = std::fwrite(&cached, sizeof(cached), 1, file) == 1;
+    }
+    for (int i = 0; ok && i < fonts->Fonts.Size; ++i) {
+        const ImVector<ImFontGlyph>& glyphs = fonts->Fonts[i]->Glyphs;
+        ok = glyphs.Size == 0 ||
+             std::fwrite(glyphs.Data, sizeof(ImFontGlyph), glyphs.Size, file) ==
+                 (std::size_t)glyphs.Size;
+    }
+    for (int i = 0; ok && i < fonts->CustomRects.Size; ++i) {
+        const ImFontAtlas::CustomRect& rect = fonts->CustomRects[i];
+        FontAtlasCacheRect cached;
+        memset(&cached, 0, sizeof(cached));
+        cached.id = rect.ID;
+        cached.width = rect.Width;
+        cached.height = rect.Height;
+        cached.x = rect.X;
+        cached.y = rect.Y;
+        cached.glyphAdvanceX = rect.GlyphAdvanceX;
+        cached.glyphOffset[0] = rect.GlyphOffset.x;
+        cached.glyphOffset[1] = rect.GlyphOffset.y;
+        cached.font = findFontIndex(fonts, rect.Font);
+        ok = std::fwrite(&cached, sizeof(cached), 1, file) == 1;
+    }
+    std::size_t pixelBytes = (std::size_t)fonts->TexWidth * fonts->TexHeight;
+    ok = ok && std::fwrite(fonts->TexPixelsAlpha8, 1, pixelBytes, file) == pixelBytes;
+    ok = std::fclose(file) == 0 && ok;
+
+    // rename doesn't replace existing files everywhere
+    if (ok) {
+        std::remove(path.c_str());
+        ok = std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        std::remove(tempPath.c_str());
+    }
+    return ok;
+}
 
-    ImGui::SFML::SetLStickXAxis(context, sf::Joystick::X);
-    ImGui::SFML::SetLStickYAxis(context, sf::Joystick::Y);
+void buildFontAtlasWithCache(ImGui::SFML::ImGuiSFMLContext& context) {
+    ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    if (fonts->ConfigData.empty()) {
+        fonts->AddFontDefault();  // what GetTexDataAsAlpha8 would do
+    }
+    unsigned long long key = fontAtlasCacheKey(fonts);
+
+    MappedFile file;
+    if (mapFile(context.fontAtlasCachePath.c_str(), file)) {
+        bool loaded = loadFontAtlasCache(fonts, key, file);
+        unmapFile(file);
+        if (loaded) {
+            return;
+        }
+    }
 
-    ImGui::SFML::SetJoytickDPadThreshold(context, 5.f);
-    ImGui::SFML::SetJoytickLStickThreshold(context, 5.f);
+    // missing or outdated: build the atlas, it's cached for the next run
+    if (!fonts->Build()) {
+        return;
+    }
+    if (!writeFontAtlasCache(fonts, key, context.fontAtlasCachePath)) {
+        sf::err() << "ImGui-SFML: failed to write the font atlas cache "
+                  << context.fontAtlasCachePath << std::endl;
+    }
 }
 
-void updateJoystickActionState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io, ImGuiNavInput_ action) {
-    bool isPressed =
-        sf::Joystick::isButtonPressed(context.joystickId, context.joystickMapping[action]);
-    io.NavInputs[action] = isPressed ? 1.0f : 0.0f;
+// Layout of a capture file, in the native byte order: header, textures, then
+// the size and bytes of each frame. A frame is a CaptureFrameHeader followed,
+// for each draw list, by its owner's name (varint length and bytes) and its
+// vertex, index and command buffers, each one a varint byte size and delta
+// runs: varint zero words, varint literal words, literal words.
+const char DRAW_DATA_CAPTURE_MAGIC[8] = {'I', 'S', 'F', 'M', 'L', 'D', 'C', '1'};
+
+struct DrawDataCaptureHeader {
+    char magic[8];
+    int layout[4];  // see captureLayout
+    int textureCount;
+    int frameCount;
+};
+
+struct CaptureTextureRecord {
+    unsigned long long id;
+    unsigned int width, height;
+    int fontTexture;
+};
+
+struct CaptureFrameHeader {
+    int keyframe;
+    int listCount;
+    float displayPos[2], displaySize[2], framebufferScale[2];
+};
+
+struct CaptureCommand {
+    float clipRect[4];
+    unsigned int texture;  // index in the capture's textures, CAPTURE_NO_TEXTURE for callbacks
+    unsigned int vtxOffset, idxOffset;
+    unsigned int elemCount;
+};
+
+const unsigned int CAPTURE_NO_TEXTURE = 0xFFFFFFFF;
+
+void captureLayout(int layout[4]) {
+    layout[0] = (int)sizeof(ImDrawVert);
+    layout[1] = (int)sizeof(ImDrawIdx);
+    layout[2] = (int)sizeof(CaptureCommand);
+    layout[3] = 0x01020304;
 }
 
-void updateJoystickDPadState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io) {
-    float dpadXPos =
-        sf::Joystick::getAxisPosition(context.joystickId, context.dPadInfo.xAxis);
-    if (context.dPadInfo.xInverted) dpadXPos = -dpadXPos;
+void appendBytes(ImVector<unsigned char>& out, const void* data, std::size_t size) {
+    int offset = out.Size;
+    out.resize(offset + (int)size);
+    if (size > 0) {
+        memcpy(out.Data + offset, data, size);
+    }
+}
 
-    float dpadYPos =
-        sf::Joystick::getAxisPosition(context.joystickId, context.dPadInfo.yAxis);
-    if (context.dPadInfo.yInverted) dpadYPos = -dpadYPos;
+void writeVarint(ImVector<unsigned char>& out, unsigned int value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
 
-    io.NavInputs[ImGuiNavInput_DpadLeft] =
-        dpadXPos < -context.dPadInfo.threshold ? 1.0f : 0.0f;
-    io.NavInputs[ImGuiNavInput_DpadRight] =
-        dpadXPos > context.dPadInfo.threshold ? 1.0f : 0.0f;
+bool readVarint(const unsigned char*& data, const unsigned char* end, unsigned int& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (data == end) return false;
+        unsigned char byte = *data++;
+        value |= (unsigned int)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
 
-    io.NavInputs[ImGuiNavInput_DpadUp] =
-        dpadYPos < -context.dPadInfo.threshold ? 1.0f : 0.0f;
-    io.NavInputs[ImGuiNavInput_DpadDown] =
-        dpadYPos > context.dPadInfo.threshold ? 1.0f : 0.0f;
+inline unsigned int loadWord(const unsigned char* bytes, std::size_t size, std::size_t offset) {
+    unsigned int word = 0;
+    if (offset + 4 <= size) {
+        memcpy(&word, bytes + offset, 4);
+    } else {
+        memcpy(&word, bytes + offset, size - offset);  // last word, padded with zeros
+    }
+    return word;
 }
 
-void updateJoystickLStickState(ImGui::SFML::ImGuiSFMLContext& context, ImGuiIO& io) {
-    float lStickXPos =
-        sf::Joystick::getAxisPosition(context.joystickId, context.lStickInfo.xAxis);
-    if (context.lStickInfo.xInverted) lStickXPos = -lStickXPos;
+// Appends data XOR-ed with previous (shorter buffers read as zeros), then
+// keeps data in previous for the next frame
+void encodeDelta(ImVector<unsigned char>& out, ImVector<unsigned char>& previous,
+                 const void* data, std::size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    unsigned int words = (unsigned int)((size + 3) / 4);
+    unsigned int previousWords = (unsigned int)previous.Size / 4;
+    const unsigned char* previousBytes = previous.Data;
+    writeVarint(out, (unsigned int)size);
+
+    unsigned int i = 0;
+    while (i < words) {
+        unsigned int zeroStart = i;
+        while (i < words && i < previousWords &&
+               loadWord(bytes, size, i * 4) == loadWord(previousBytes, previous.Size, i * 4)) {
+            ++i;
+        }
+        unsigned int literalStart = i;
+        while (i < words && (i >= previousWords || loadWord(bytes, size, i * 4) !=
+                                                       loadWord(previousBytes, previous.Size, i * 4))) {
+            ++i;
+        }
+        writeVarint(out, literalStart - zeroStart);
+        writeVarint(out, i - literalStart);
+        int offset = out.Size;
+        out.resize(offset + (int)(i - literalStart) * 4);
+        for (unsigned int w = literalStart; w < i; ++w) {
+            unsigned int delta = loadWord(bytes, size, w * 4);
+            if (w < previousWords) delta ^= loadWord(previousBytes, previous.Size, w * 4);
+            memcpy(out.Data + offset + (w - literalStart) * 4, &delta, 4);
+        }
+    }
 
-    float lStickYPos =
-        sf::Joystick::getAxisPosition(context.joystickId, context.lStickInfo.yAxis);
-    if (context.lStickInfo.yInverted) lStickYPos = -lStickYPos;
+    previous.resize((int)words * 4);
+    if (words > 0) {
+        previous[(int)words * 4 - 1] = previous[(int)words * 4 - 2] =
+            previous[(int)words * 4 - 3] = 0;
+        memcpy(previous.Data, bytes, size);
+    }
+}
 
-    if (lStickXPos < -context.lStickInfo.threshold) {
-        io.NavInputs[ImGuiNavInput_LStickLeft] = std::abs(lStickXPos / 100.f);
+// Applies the runs of encodeDelta to buffer, which holds the previous frame's data
+bool decodeDelta(const unsigned char*& data, const unsigned char* end,
+                 ImVector<unsigned char>& buffer, unsigned int& size) {
+    if (!readVarint(data, end, size)) return false;
+    unsigned int words = (size + 3) / 4;
+    int oldSize = buffer.Size;
+    buffer.resize((int)words * 4);
+    if (buffer.Size > oldSize) {
+        memset(buffer.Data + oldSize, 0, buffer.Size - oldSize);
     }
 
-    if (lStickXPos > context.lStickInfo.threshold) {
-        io.NavInputs[ImGuiNavInput_LStickRight] = lStickXPos / 100.f;
+    unsigned int i = 0;
+    while (i < words) {
+        unsigned int zeros, literals;
+        if (!readVarint(data, end, zeros) || !readVarint(data, end, literals) ||
+            zeros > words - i || literals > words - i - zeros ||
+            (std::size_t)(end - data) < (std::size_t)literals * 4) {
+            return false;
+        }
+        i += zeros;
+        for (unsigned int w = 0; w < literals; ++w, ++i) {
+            unsigned int word, delta;
+            memcpy(&word, buffer.Data + i * 4, 4);
+            memcpy(&delta, data + w * 4, 4);
+            word ^= delta;
+            memcpy(buffer.Data + i * 4, &word, 4);
+        }
+        data += literals * 4;
     }
+    return true;
+}
 
-    if (lStickYPos < -context.lStickInfo.threshold) {
-        io.NavInputs[ImGuiNavInput_LStickUp] = std::abs(lStickYPos / 100.f);
+unsigned int captureTextureIndex(ImGui::SFML::ImGuiSFMLContext& context,
+                                 CaptureRecorder& recorder, ImTextureID textureID) {
+    ImGuiID key = ImHashData(&textureID, sizeof(textureID));
+    int index = recorder.textureSlots.GetInt(key) - 1;
+    if (index >= 0 && recorder.textures[index].id == textureID) {
+        recorder.textureLastFrames[index] = recorder.frame;
+        return (unsigned int)index;
+    }
+    // two IDs with the same hash: the second one isn't in textureSlots
+    for (int i = 0; i < recorder.textures.Size; ++i) {
+        if (recorder.textureLastFrames[i] >= 0 && recorder.textures[i].id == textureID) {
+            recorder.textureLastFrames[i] = recorder.frame;
+            return (unsigned int)i;
+        }
     }
 
-    if (lStickYPos > context.lStickInfo.threshold) {
-        io.NavInputs[ImGuiNavInput_LStickDown] = lStickYPos / 100.f;
+    ImGui::SFML::CaptureTexture texture;
+    texture.id = texture.replayID = textureID;
+    texture.size = sf::Vector2u(0, 0);
+    const ImFontAtlas* fonts = context.imguiContext->IO.Fonts;
+    texture.fontTexture = textureID == fonts->TexID;
+    if (texture.fontTexture) {
+        texture.size = sf::Vector2u((unsigned int)fonts->TexWidth, (unsigned int)fonts->TexHeight);
+    } else {
+        getRegisteredTextureSize(context, textureID, texture.size);
     }
+    int slot;
+    if (!recorder.freeTextures.empty()) {
+        slot = recorder.freeTextures.back();
+        recorder.freeTextures.pop_back();
+        recorder.textures[slot] = texture;
+    } else {
+        slot = recorder.textures.Size;
+        recorder.textures.push_back(texture);
+        recorder.textureLastFrames.push_back(0);
+    }
+    recorder.textureLastFrames[slot] = recorder.frame;
+    if (index < 0) {
+        recorder.textureSlots.SetInt(key, slot + 1);
+    }
+    return (unsigned int)slot;
 }
 
-void setClipboardText(void* userData, const char* text) {
-    sf::Clipboard::setString(sf::String::fromUtf8(text, text + std::strlen(text)));
+void freeUnusedCaptureTextures(CaptureRecorder& recorder) {
+    // once this frame is in the ring, the oldest frame it holds is this one
+    int oldestFrame = recorder.frame - recorder.frames.Size + 1;
+    for (int i = 0; i < recorder.textures.Size; ++i) {
+        int lastFrame = recorder.textureLastFrames[i];
+        if (lastFrame < 0 || lastFrame >= oldestFrame) {
+            continue;
+        }
+        ImTextureID textureID = recorder.textures[i].id;
+        ImGuiID key = ImHashData(&textureID, sizeof(textureID));
+        if (recorder.textureSlots.GetInt(key) == i + 1) {
+            recorder.textureSlots.SetInt(key, 0);
+        }
+        recorder.textures[i].id = recorder.textures[i].replayID = (ImTextureID)NULL;
+        recorder.textures[i].size = sf::Vector2u(0, 0);
+        recorder.textures[i].fontTexture = false;
+        recorder.textureLastFrames[i] = -1;
+        recorder.freeTextures.push_back(i);
+    }
 }
 
-const char* getClipboadText(void* userData) {
-    ImGui::SFML::ImGuiSFMLContext* contextPtr = (ImGui::SFML::ImGuiSFMLContext*)userData;
-    std::basic_string<sf::Uint8> tmp = sf::Clipboard::getString().toUtf8();
-    contextPtr->clipboardText = std::string(tmp.begin(), tmp.end());
-    return contextPtr->clipboardText.c_str();
+void captureDrawData(ImGui::SFML::ImGuiSFMLContext& context, const ImDrawData* draw_data) {
+    if (!context.captureRecorder) {
+        context.captureRecorder = IM_NEW(CaptureRecorder)();
+    }
+    CaptureRecorder& recorder = *context.captureRecorder;
+
+    // the ring keeps its buffers, so recording stops allocating once frames stop growing.
+    // Resizing it drops the frames it holds.
+    if (recorder.frames.Size != context.captureFrames) {
+        while (recorder.frames.Size > context.captureFrames) {
+            IM_DELETE(recorder.frames.back());
+            recorder.frames.pop_back();
+        }
+        while (recorder.frames.Size < context.captureFrames) {
+            recorder.frames.push_back(IM_NEW(ImVector<unsigned char>)());
+        }
+        recorder.next = recorder.count = recorder.sinceKeyframe = 0;
+    }
+
+    int interval = ImMax(1, ImMin(context.captureKeyframeInterval, context.captureFrames));
+    bool keyframe = recorder.sinceKeyframe <= 0 || recorder.sinceKeyframe >= interval;
+    recorder.sinceKeyframe = keyframe ? 1 : recorder.sinceKeyframe + 1;
+    ++recorder.frame;
+    if (keyframe) {
+        freeUnusedCaptureTextures(recorder);
+        // all of them, as a list can come back after frames without it
+        for (int n = 0; n < recorder.lists.Size; ++n) {
+            recorder.lists[n]->vtx.resize(0);
+            recorder.lists[n]->idx.resize(0);
+            recorder.lists[n]->cmd.resize(0);
+        }
+    }
+
+    ImVector<unsigned char>& out = *recorder.frames[recorder.next];
+    out.resize(0);
+    const ImVec2& framebufferScale = context.imguiContext->IO.DisplayFramebufferScale;
+    CaptureFrameHeader header;
+    memset(&header, 0, sizeof(header));
+    header.keyframe = keyframe ? 1 : 0;
+    header.listCount = draw_data->CmdListsCount;
+    header.displayPos[0] = draw_data->DisplayPos.x;
+    header.displayPos[1] = draw_data->DisplayPos.y;
+    header.displaySize[0] = draw_data->DisplaySize.x;
+    header.displaySize[1] = draw_data->DisplaySize.y;
+    header.framebufferScale[0] = framebufferScale.x;
+    header.framebufferScale[1] = framebufferScale.y;
+    appendBytes(out, &header, sizeof(header));
+
+    while (recorder.lists.Size < draw_data->CmdListsCount) {
+        recorder.lists.push_back(IM_NEW(DrawDataCapture::List)());
+    }
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        DrawDataCapture::List& list = *recorder.lists[n];
+
+        const char* owner = cmd_list->_OwnerName ? cmd_list->_OwnerName : "";
+        unsigned int ownerLength = (unsigned int)std::strlen(owner);
+        writeVarint(out, ownerLength);
+        appendBytes(out, owner, ownerLength);
+
+        encodeDelta(out, list.vtx, cmd_list->VtxBuffer.Data,
+                    cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+        encodeDelta(out, list.idx, cmd_list->IdxBuffer.Data,
+                    cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+
+        // textures are only looked up when they change
+        recorder.commands.resize(cmd_list->CmdBuffer.Size * (int)sizeof(CaptureCommand));
+        ImTextureID textureID = (ImTextureID)NULL;
+        unsigned int texture = CAPTURE_NO_TEXTURE;
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; ++cmd_i) {
+            const ImDrawCmd& pcmd = cmd_list->CmdBuffer[cmd_i];
+            CaptureCommand command;
+            memset(&command, 0, sizeof(command));
+            command.elemCount = pcmd.ElemCount;
+#if IMGUI_VERSION_NUM >= 17100
+            command.vtxOffset = pcmd.VtxOffset;
+            command.idxOffset = pcmd.IdxOffset;
+#endif
+            if (pcmd.UserCallback) {
+                // can't be replayed: an empty clip rect skips its indices
+                command.texture = CAPTURE_NO_TEXTURE;
+            } else {
+                if (texture == CAPTURE_NO_TEXTURE || pcmd.TextureId != textureID) {
+                    textureID = pcmd.TextureId;
+                    texture = captureTextureIndex(context, recorder, textureID);
+                }
+                command.texture = texture;
+                command.clipRect[0] = pcmd.ClipRect.x;
+                command.clipRect[1] = pcmd.ClipRect.y;
+                command.clipRect[2] = pcmd.ClipRect.z;
+                command.clipRect[3] = pcmd.ClipRect.w;
+            }
+            memcpy(recorder.commands.Data + cmd_i * sizeof(CaptureCommand), &command,
+                   sizeof(command));
+        }
+        encodeDelta(out, list.cmd, recorder.commands.Data, recorder.commands.Size);
+    }
+
+    recorder.next = (recorder.next + 1) % recorder.frames.Size;
+    recorder.count = ImMin(recorder.count + 1, recorder.frames.Size);
+}
+
+bool isCaptureKeyframe(const unsigned char* frame, std::size_t size) {
+    CaptureFrameHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, frame, sizeof(header));
+    return header.keyframe != 0;
+}
+
+bool writeCapture(const CaptureRecorder& recorder, const char* filename) {
+    // oldest frame first, from the first keyframe on
+    int size = recorder.frames.Size;
+    int oldest = (recorder.next - recorder.count + size) % size;
+    int first = 0;
+    while (first < recorder.count) {
+        const ImVector<unsigned char>& frame = *recorder.frames[(oldest + first) % size];
+        if (isCaptureKeyframe(frame.Data, frame.Size)) break;
+        ++first;
+    }
+    if (first == recorder.count) {
+        return false;
+    }
+
+    // written next to the file and renamed, so that readers never see half a file
+    std::string path = filename;
+    std::string tempPath = path + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    DrawDataCaptureHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DRAW_DATA_CAPTURE_MAGIC, sizeof(header.magic));
+    captureLayout(header.layout);
+    header.textureCount = recorder.textures.Size;
+    header.frameCount = recorder.count - first;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (int i = 0; ok && i < recorder.textures.Size; ++i) {
+        const ImGui::SFML::CaptureTexture& texture = recorder.textures[i];
+        CaptureTextureRecord record;
+        memset(&record, 0, sizeof(record));
+        record.id = (unsigned long long)(std::size_t)texture.id;
+        record.width = texture.size.x;
+        record.height = texture.size.y;
+        record.fontTexture = texture.fontTexture ? 1 : 0;
+        ok = std::fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    for (int i = first; ok && i < recorder.count; ++i) {
+        const ImVector<unsigned char>& frame = *recorder.frames[(oldest + i) % size];
+        unsigned int frameSize = (unsigned int)frame.Size;
+        ok = std::fwrite(&frameSize, sizeof(frameSize), 1, file) == 1 &&
+             std::fwrite(frame.Data, 1, frame.Size, file) == (std::size_t)frame.Size;
+    }
+    ok = std::fclose(file) == 0 && ok;
+
+    // rename doesn't replace existing files everywhere
+    if (ok) {
+        std::remove(path.c_str());
+        ok = std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        std::remove(tempPath.c_str());
+    }
+    return ok;
+}
+
+// Checks the sizes in the mapped file before anything is read from it
+bool readCapture(DrawDataCapture& capture, const char* filename) {
+    MappedFile file;
+    if (!mapFile(filename, file)) {
+        return false;
+    }
+    const unsigned char* data = file.data;
+    const unsigned char* end = file.data + file.size;
+
+    DrawDataCaptureHeader header;
+    int layout[4];
+    captureLayout(layout);
+    bool ok = file.size >= sizeof(header);
+    if (ok) {
+        memcpy(&header, data, sizeof(header));
+        data += sizeof(header);
+        ok = memcmp(header.magic, DRAW_DATA_CAPTURE_MAGIC, sizeof(header.magic)) == 0 &&
+             memcmp(header.layout, layout, sizeof(layout)) == 0 && header.textureCount >= 0 &&
+             header.frameCount > 0 &&
+             (std::size_t)(end - data) >= header.textureCount * sizeof(CaptureTextureRecord);
+    }
+
+    for (int i = 0; ok && i < header.textureCount; ++i) {
+        CaptureTextureRecord record;
+        memcpy(&record, data, sizeof(record));
+        data += sizeof(record);
+        ImGui::SFML::CaptureTexture texture;
+        texture.id = texture.replayID = (ImTextureID)(std::size_t)record.id;
+        texture.size = sf::Vector2u(record.width, record.height);
+        texture.fontTexture = record.fontTexture != 0;
+        capture.textures.push_back(texture);
+    }
+
+    capture.frameOffsets.push_back(0);
+    for (int i = 0; ok && i < header.frameCount; ++i) {
+        unsigned int frameSize;
+        ok = (std::size_t)(end - data) >= sizeof(frameSize);
+        if (ok) {
+            memcpy(&frameSize, data, sizeof(frameSize));
+            data += sizeof(frameSize);
+            ok = (std::size_t)(end - data) >= frameSize;
+        }
+        if (ok) {
+            appendBytes(capture.frames, data, frameSize);
+            data += frameSize;
+            capture.frameOffsets.push_back((unsigned int)capture.frames.Size);
+        }
+    }
+    ok = ok && data == end;
+    unmapFile(file);
+    return ok;
+}
+
+// The renderers walk the indices command by command and trust them, so a
+// truncated or mismatched capture must not reach them
+bool isCaptureListValid(const ImDrawList& list) {
+    unsigned int idxBegin = 0;
+    unsigned int vtxCount = (unsigned int)list.VtxBuffer.Size;
+    unsigned int idxCount = (unsigned int)list.IdxBuffer.Size;
+    for (int cmd_i = 0; cmd_i < list.CmdBuffer.Size; ++cmd_i) {
+        const ImDrawCmd& pcmd = list.CmdBuffer[cmd_i];
+        if (pcmd.ElemCount > idxCount - idxBegin) {
+            return false;
+        }
+        unsigned int vtxOffset = 0;
+#if IMGUI_VERSION_NUM >= 17100
+        if (pcmd.IdxOffset > idxCount || pcmd.ElemCount > idxCount - pcmd.IdxOffset ||
+            pcmd.VtxOffset > vtxCount) {
+            return false;
+        }
+        vtxOffset = pcmd.VtxOffset;
+#endif
+        const ImDrawIdx* indices = list.IdxBuffer.Data + idxBegin;
+        for (unsigned int i = 0; i < pcmd.ElemCount; ++i) {
+            if (indices[i] >= vtxCount - vtxOffset) {
+                return false;
+            }
+        }
+        idxBegin += pcmd.ElemCount;
+    }
+    return true;
+}
+
+bool decodeCaptureFrame(DrawDataCapture& capture, int frame) {
+    const unsigned char* data = capture.frames.Data + capture.frameOffsets[frame];
+    const unsigned char* end = capture.frames.Data + capture.frameOffsets[frame + 1];
+
+    CaptureFrameHeader header;
+    if ((std::size_t)(end - data) < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    data += sizeof(header);
+    if (header.listCount < 0) return false;
+
+    if (header.keyframe) {
+        for (int n = 0; n < capture.lists.Size; ++n) {
+            capture.lists[n]->vtx.resize(0);
+            capture.lists[n]->idx.resize(0);
+            capture.lists[n]->cmd.resize(0);
+        }
+    }
+    ImGui::SFML::ImGuiSFMLContext::DrawDataSnapshot& snapshot = capture.snapshot;
+    while (capture.lists.Size < header.listCount) {
+        capture.lists.push_back(IM_NEW(DrawDataCapture::List)());
+    }
+    while (snapshot.lists.Size < header.listCount) {
+        // only the buffers are used, the lists don't need ImGui's shared data
+        snapshot.lists.push_back(IM_NEW(ImDrawList)(NULL));
+    }
+
+    int totalVtxCount = 0, totalIdxCount = 0;
+    for (int n = 0; n < header.listCount; ++n) {
+        DrawDataCapture::List& list = *capture.lists[n];
+        unsigned int ownerLength;
+        if (!readVarint(data, end, ownerLength) || (std::size_t)(end - data) < ownerLength) {
+            return false;
+        }
+        list.owner.resize((int)ownerLength + 1);
+        memcpy(list.owner.Data, data, ownerLength);
+        list.owner[(int)ownerLength] = '\0';
+        data += ownerLength;
+
+        unsigned int vtxBytes, idxBytes, cmdBytes;
+        if (!decodeDelta(data, end, list.vtx, vtxBytes) ||
+            !decodeDelta(data, end, list.idx, idxBytes) ||
+            !decodeDelta(data, end, list.cmd, cmdBytes) || vtxBytes % sizeof(ImDrawVert) != 0 ||
+            idxBytes % sizeof(ImDrawIdx) != 0 || cmdBytes % sizeof(CaptureCommand) != 0) {
+            return false;
+        }
+
+        ImDrawList* dst = snapshot.lists[n];
+        dst->VtxBuffer.resize((int)(vtxBytes / sizeof(ImDrawVert)));
+        if (vtxBytes > 0) memcpy(dst->VtxBuffer.Data, list.vtx.Data, vtxBytes);
+        dst->IdxBuffer.resize((int)(idxBytes / sizeof(ImDrawIdx)));
+        if (idxBytes > 0) memcpy(dst->IdxBuffer.Data, list.idx.Data, idxBytes);
+        dst->CmdBuffer.resize((int)(cmdBytes / sizeof(CaptureCommand)));
+        for (int cmd_i = 0; cmd_i < dst->CmdBuffer.Size; ++cmd_i) {
+            CaptureCommand command;
+            memcpy(&command, list.cmd.Data + cmd_i * sizeof(CaptureCommand), sizeof(command));
+            ImDrawCmd& pcmd = dst->CmdBuffer[cmd_i];
+            pcmd = ImDrawCmd();
+            pcmd.ElemCount = command.elemCount;
+            pcmd.ClipRect = ImVec4(command.clipRect[0], command.clipRect[1],
+                                   command.clipRect[2], command.clipRect[3]);
+            pcmd.TextureId = command.texture < (unsigned int)capture.textures.Size
+                                 ? capture.textures[(int)command.texture].replayID
+                                 : (ImTextureID)NULL;
+#if IMGUI_VERSION_NUM >= 17100
+            pcmd.VtxOffset = command.vtxOffset;
+            pcmd.IdxOffset = command.idxOffset;
+#endif
+        }
+        if (!isCaptureListValid(*dst)) {
+            return false;
+        }
+        dst->_OwnerName = ownerLength > 0 ? list.owner.Data : NULL;
+        totalVtxCount += dst->VtxBuffer.Size;
+        totalIdxCount += dst->IdxBuffer.Size;
+    }
+
+    ImDrawData& drawData = snapshot.data;
+    drawData = ImDrawData();
+    drawData.Valid = true;
+    drawData.CmdLists = snapshot.lists.Data;
+    drawData.CmdListsCount = header.listCount;
+    drawData.TotalVtxCount = totalVtxCount;
+    drawData.TotalIdxCount = totalIdxCount;
+    drawData.DisplayPos = ImVec2(header.displayPos[0], header.displayPos[1]);
+    drawData.DisplaySize = ImVec2(header.displaySize[0], header.displaySize[1]);
+    snapshot.framebufferScale = ImVec2(header.framebufferScale[0], header.framebufferScale[1]);
+#if IMGUI_VERSION_NUM >= 16900
+    drawData.FramebufferScale = snapshot.framebufferScale;
+#endif
+    return data == end;
 }
 
 void loadMouseCursor(ImGui::SFML::ImGuiSFMLContext& context, ImGuiMouseCursor imguiCursorType,
                      sf::Cursor::Type sfmlCursorType) {
-    context.mouseCursors[imguiCursorType] = new sf::Cursor();
+    context.mouseCursors[imguiCursorType] = IM_NEW(sf::Cursor);
     context.mouseCursorLoaded[imguiCursorType] =
         context.mouseCursors[imguiCursorType]->loadFromSystem(sfmlCursorType);
 }
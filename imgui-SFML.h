@@ -4,19 +4,30 @@
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/System/Clock.hpp>
 #include <SFML/System/Time.hpp>
 #include <SFML/Window/Joystick.hpp>
 #include <imgui.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include "imgui-SFML_export.h"
 
 namespace sf
 {
     class Event;
+    class Image;
     class RenderTarget;
+    class RenderTexture;
     class RenderWindow;
     class Sprite;
     class Texture;
+    class Vertex;
+    class VertexArray;
     class Window;
     class Cursor;
 }
@@ -28,6 +39,34 @@ namespace ImGui
         IMGUI_SFML_API extern const unsigned int NULL_JOYSTICK_ID;
         IMGUI_SFML_API extern const unsigned int NULL_JOYSTICK_BUTTON;
 
+        // Font atlas and font texture shared by several contexts (one per window, say), so
+        // that the fonts are built, uploaded and stored once. See CreateSharedFontAtlas.
+        // ImGui writes to the atlas in NewFrame and EndFrame: the contexts must build
+        // their frames on the thread which created it (Update and Render assert it).
+        struct SharedFontAtlas
+        {
+			ImFontAtlas* atlas = NULL; // add fonts before the first Init, then UpdateSharedFontTexture
+			sf::Texture* texture = NULL; // RGBA32
+			std::atomic<int> refCount{1}; // the creator's reference and one per context
+			std::thread::id thread; // set by CreateSharedFontAtlas
+        };
+
+        // Rendering paths which can be chosen before calling Init
+        enum RendererType {
+            Renderer_FixedFunction, // OpenGL 1.x / GLES 1 fixed-function pipeline
+            Renderer_Shader         // OpenGL 3.x (core or compatibility) / GLES 3 programmable pipeline
+        };
+
+        // Draw data capture read by LoadCapture, see ImGuiSFMLContext::captureFrames
+        struct DrawDataCapture;
+        struct CaptureTexture
+        {
+            ImTextureID id; // as recorded
+            sf::Vector2u size; // (0, 0) if unknown, for GL names given to ImGui directly
+            bool fontTexture;
+            ImTextureID replayID; // drawn instead of id by the frames of GetCaptureFrame, id by default
+        };
+
         IMGUI_SFML_API struct ImGuiSFMLContext
         {
 			bool windowHasFocus = false;
@@ -35,6 +74,38 @@ namespace ImGui
 			bool touchDown[3] = { false, false, false };
 			bool mouseMoved = false;
 			sf::Vector2i touchPos;
+
+			// Input state: mouse buttons, mouse and touch positions and the buttons and axes of
+			// the active joystick are tracked from the events passed to ProcessEvent. If
+			// pollInputDevices is set, Update queries them from the OS every frame instead.
+			bool pollInputDevices = false;
+			bool mouseHeld[3] = { false, false, false };
+			bool touchHeld[3] = { false, false, false };
+			sf::Vector2i mousePosition; // of the last mouse move or button event, off-window after MouseLeft
+			bool joystickButtons[sf::Joystick::ButtonCount] = {}; // of joystickId, released when it changes
+			float joystickAxes[sf::Joystick::AxisCount] = {};
+			struct InputStats {
+				unsigned int frameQueries = 0; // OS input queries since the last Update which started a frame
+				unsigned int totalQueries = 0;
+			};
+			InputStats inputStats;
+
+			// Input queue: if set (before Init), ProcessEvent only records the events with their
+			// time, and Update applies them in order. Events which would change a key or button
+			// that already changed in the frame (the release of a press) are held back for the
+			// next frames, so no click or key tap is lost to a long frame. Filled by ProcessEvent or
+			// QueueEvent, from a single thread which may be another one than Update's.
+			bool queueInput = false;
+			unsigned int inputQueueCapacity = 1024; // events, rounded up to a power of two
+			struct InputQueue;
+			InputQueue* inputQueue = NULL; // owning pointer, created by Init
+			struct InputQueueStats {
+				unsigned int appliedEvents = 0; // by the last Update which started a frame
+				unsigned int heldBackEvents = 0; // left in the queue by it
+				sf::Time maxLatency; // age of its oldest applied event
+				unsigned int droppedEvents = 0; // in total, as the queue was full
+			};
+			InputQueueStats inputQueueStats;
 			sf::Texture* fontTexture = NULL; // owning pointer to internal font atlas which is used if user doesn't set custom sf::Texture.
 			unsigned int joystickId = NULL_JOYSTICK_ID;
 			unsigned int joystickMapping[ImGuiNavInput_COUNT];
@@ -51,29 +122,349 @@ namespace ImGui
 			StickInfo dPadInfo;
 			StickInfo lStickInfo;
 			std::string clipboardText;
-			sf::Cursor* mouseCursors[ImGuiMouseCursor_COUNT];
-			bool mouseCursorLoaded[ImGuiMouseCursor_COUNT];
+			sf::Cursor* mouseCursors[ImGuiMouseCursor_COUNT] = {}; // owning pointers, created by Init
+			bool mouseCursorLoaded[ImGuiMouseCursor_COUNT] = {};
             ImGuiContext* imguiContext = NULL;
+			SharedFontAtlas* sharedFontAtlas = NULL; // set by Init, released by Shutdown
+
+			// Renderer: if set, vertex/index data is streamed through ring-buffered
+			// GL buffer objects (one upload per frame) instead of client-side arrays.
+			// Falls back to client-side arrays if buffer objects are unavailable.
+			bool useVertexBuffers = false;
+			unsigned int vertexBuffer = 0; // GL buffer names, created on first use
+			unsigned int indexBuffer = 0;
+			unsigned int vertexBufferCapacity = 0; // in bytes
+			unsigned int indexBufferCapacity = 0;
+			unsigned int vertexBufferOffset = 0; // write position in the ring buffer
+			unsigned int indexBufferOffset = 0;
+
+			// Rendering path. Init falls back to (and sets this to) Renderer_FixedFunction
+			// if the window's GL context can't run the shader path.
+			// Renderer_Shader always streams through vertex buffers.
+			RendererType renderer = Renderer_FixedFunction;
+			struct ShaderObjects {
+				unsigned int program = 0; // created in Init
+				unsigned int vertexArray = 0; // created on first Render, as VAOs aren't shared between GL contexts
+				int projectionLocation = -1;
+				int textureLocation = -1;
+				int positionLocation = -1;
+				int uvLocation = -1;
+				int colorLocation = -1;
+			};
+			ShaderObjects shader;
+
+			// Font atlas: if set, UpdateFontTexture uploads ImGui's single-channel atlas
+			// (GetTexDataAsAlpha8), a quarter of the memory and upload size of RGBA32. It's
+			// a GL_ALPHA texture with Renderer_FixedFunction and a swizzled GL_R8 one with
+			// Renderer_Shader (GL 3.3 / GLES 3, RGBA32 is used otherwise). GetFontTexture
+			// then returns an RGBA copy of the atlas, made the first time it's called.
+			bool alpha8FontAtlas = false;
+			unsigned int fontAtlasTexture = 0; // GL name of the alpha8 atlas
+			bool fontTextureStale = false; // fontTexture has to be copied from the alpha8 atlas
+
+			// Font atlas: if set, UpdateFontTexture (and Init with the default font) restores
+			// the built atlas from this file instead of rasterizing the glyphs again. The file
+			// is rewritten whenever the fonts, their settings or the ImGui version change.
+			std::string fontAtlasCachePath;
+
+			// Dynamic fonts (AddDynamicFontFromFileTTF): their glyphs are rasterized the first
+			// time they're drawn, into a region of this size reserved in the font atlas.
+			// When it's full, the glyphs which weren't drawn for the longest time are evicted.
+			int dynamicAtlasWidth = 1024;
+			int dynamicAtlasHeight = 1024;
+			struct DynamicAtlas;
+			DynamicAtlas* dynamicAtlas = NULL; // owning pointer, created by AddDynamicFontFromFileTTF
+
+			// Renderer: if set, Render(context, target) doesn't call resetGLStates and no
+			// glPushAttrib or glGet* call is made. Only the state ImGui needs is changed, and
+			// it's put back to the state SFML keeps between its draws (sf::BlendAlpha as the
+			// last blend mode, no buffer/program bound, the target's view as viewport).
+			// SFML's blend mode is set to sf::BlendAlpha with an invisible draw beforehand.
+			// ImGui textures are bound to texture unit 1, so SFML's binding on unit 0 stays valid.
+			bool minimalGLStateChanges = false;
+			int targetViewport[4] = { 0, 0, 0, 0 }; // GL viewport restored afterwards, set by Render(context, target). Zero size means the whole display.
+
+			// Renderer: if set, Render(context, target) draws ImGui into an offscreen texture
+			// which is composited onto the target. The texture is only redrawn when the draw
+			// data changes (compared with a hash of vertices, indices, clip rects and texture IDs).
+			// Frames with user callbacks are always drawn directly.
+			bool cacheRendering = false;
+			sf::RenderTexture* renderCache = NULL; // owning pointer, created on first use
+			unsigned long long renderCacheHash = 0;
+			bool renderCacheValid = false; // see InvalidateRenderCache
+
+			// Idle mode (see IsFrameNeeded and WaitEvent)
+			int framesPending = 0; // frames to run until ImGui settles after input, raised by ProcessEvent
+			sf::Clock idleClock; // time since the last Update
+
+			// Deep copy of ImDrawData which can be drawn without touching ImGui's state.
+			// Buffers keep their capacity, so copying stops allocating once the UI stops growing.
+			struct DrawDataSnapshot {
+				ImDrawData data;
+				ImVector<ImDrawList*> lists; // owning, storage of data.CmdLists
+				ImVec2 framebufferScale;
+			};
+
+			// UI update rate (see SetUpdateRate)
+			sf::Time updateInterval; // sf::Time::Zero: ImGui is rebuilt on every Update
+			sf::Time timeSinceUpdate; // dt accumulated over the Updates which didn't rebuild ImGui
+			bool frameBuilt = false; // the last Update called ImGui::NewFrame
+			DrawDataSnapshot drawDataCopy; // last built frame, drawn again until ImGui is rebuilt
+
+			// Frames handed from the thread building the UI to the thread rendering it
+			// (see SubmitSnapshot). Guarded by snapshotMutex.
+			DrawDataSnapshot snapshots[2];
+			int snapshotReady = -1; // submitted and not picked by RenderSnapshot yet
+			int snapshotRendered = -1; // last one picked by RenderSnapshot, never written by SubmitSnapshot
+			std::mutex snapshotMutex;
+
+			// Memory: allocator used for ImGui's allocations and the binding's own objects
+			// while this context is current (from Init or Update until another context's
+			// Update). Set before Init, with both functions or none (malloc/free).
+			struct Allocator {
+				void* (*allocFunc)(size_t size, void* userData) = NULL;
+				void (*freeFunc)(void* ptr, void* userData) = NULL;
+				void* userData = NULL;
+			};
+			Allocator allocator;
+			struct AllocationStats {
+				unsigned int frameAllocations = 0; // since the last Update which started a frame
+				size_t frameBytes = 0;
+				unsigned int totalAllocations = 0;
+				size_t bytesInUse = 0; // approximate if blocks are freed while another context is current
+			};
+			AllocationStats allocationStats;
+
+			// Texture registry: the ImTextureIDs ImGui-SFML gives ImGui for sf::Textures (see
+			// GetTextureID) index these records, so the renderer knows what it binds. IDs of
+			// unregistered or re-created textures are detected and not drawn. Shared with
+			// RenderSnapshot's thread, guarded by snapshotMutex.
+			struct TextureRecord {
+				const sf::Texture* texture = NULL; // NULL if the slot is free
+				unsigned int glName = 0;
+				sf::Vector2u size;
+				bool smooth = false;
+				bool repeated = false;
+				unsigned int generation = 0; // part of the ID, bumped when the slot's texture changes
+			};
+			ImVector<TextureRecord> textures;
+			ImGuiStorage textureSlots; // hash of the sf::Texture address -> index in textures + 1
+			ImVector<int> freeTextureSlots;
+
+			// Texture atlasing: if set, textures of at most smallTextureMaxSize pixels (on both
+			// sides) drawn with the Image/ImageButton overloads are copied (on the GPU) into
+			// shared pages, so that grids of icons are drawn with a few draw calls. Pages whose
+			// textures weren't drawn for atlasEvictFrames frames are freed. Repeated textures
+			// aren't atlased. Call UnregisterTexture after updating the pixels of a texture.
+			bool atlasSmallTextures = false;
+			unsigned int smallTextureMaxSize = 64;
+			unsigned int atlasPageSize = 1024;
+			int maxAtlasPages = 4;
+			int atlasEvictFrames = 120;
+			struct TextureAtlas;
+			TextureAtlas* textureAtlas = NULL; // owning pointer, created by the first atlased texture
+
+			// Software rendering (see RenderToImage)
+			struct SoftwareTexture {
+				ImTextureID id;
+				const sf::Image* image;
+			};
+			struct SoftwareTriangle; // set up once, then rasterized by every thread
+			ImVector<SoftwareTexture> softwareTextures; // registered with SetSoftwareTexture
+			ImVector<SoftwareTriangle> softwareTriangles;
+			ImVector<unsigned int> softwarePixels; // RGBA, copied to the sf::Image
+			unsigned int softwareThreads = 0; // 0: one per hardware thread
+			struct SoftwareWorkers;
+			SoftwareWorkers* softwareWorkers = NULL; // owning pointer, threads kept between renders
+
+			// Counters of the last RenderDrawLists call
+			struct RenderStats {
+				unsigned int drawCalls = 0;
+				unsigned int textureBinds = 0;
+				unsigned int scissorChanges = 0;
+				unsigned int culledCommands = 0; // commands with an empty or off-screen clip rect
+				unsigned int mergedCommands = 0; // commands folded into the previous draw call
+				unsigned int skippedTextureBinds = 0; // redundant glBindTexture calls which weren't made
+				unsigned int skippedScissorChanges = 0; // redundant glScissor calls which weren't made
+				bool fromRenderCache = false; // the last frame was composited from renderCache, no draw list was submitted
+				unsigned int invalidTextureCommands = 0; // commands skipped as their texture was unregistered or re-created
+			};
+			RenderStats renderStats;
+
+			// Profiler: if set, the time spent in ImGui-SFML's phases and the render counters of
+			// the last profilerHistorySize frames are kept (see GetFrameProfile). A frame goes
+			// from the events before the Update which starts it to the next such Update.
+			struct FrameProfile {
+				float processEventMs = 0.f;
+				float mouseCursorMs = 0.f;
+				float inputMs = 0.f; // Update: queued events, mouse and keyboard state
+				float gamepadMs = 0.f;
+				float newFrameMs = 0.f;
+				float imguiRenderMs = 0.f; // ImGui::Render, in Render or SubmitSnapshot
+				float submitMs = 0.f; // GL submission of the draw lists
+				float fontTextureMs = 0.f; // UpdateFontTexture
+				unsigned int events = 0;
+				unsigned int vertices = 0; // submitted, summed over the renders of the frame
+				unsigned int indices = 0;
+				unsigned int drawCalls = 0;
+				unsigned int textureBinds = 0;
+				unsigned int scissorChanges = 0;
+				float gpuMs = 0.f; // GPU timing read back during the frame (see gpuTiming), 0 if none
+			};
+			bool enableProfiler = false;
+			int profilerHistorySize = 240;
+			// guarded by snapshotMutex, as RenderSnapshot's thread records its submissions
+			ImVector<FrameProfile> profilerHistory; // ring buffer
+			int profilerHistoryNext = 0;
+			int profilerHistoryCount = 0;
+			bool profilerFrameStarted = false;
+			FrameProfile profilerFrame; // of the frame being built
+			FrameProfile profilerPending; // of the next frame, until its Update
+
+			// GPU timing: if set and the GL context has timer queries (GL 3.3, GL_ARB_timer_query
+			// or GL_EXT_disjoint_timer_query), RenderDrawLists brackets its GL commands with
+			// timestamp queries. They're read back by a later render, once the GPU is done with
+			// them, so the timings are a few frames old but rendering never waits on the GPU.
+			// Set before Init.
+			bool gpuTiming = false;
+			bool gpuTimingPerList = false; // also time each draw list (up to 64), i.e. each ImGui window
+			struct GPUTimings {
+				struct List {
+					char owner[64]; // name of the window which built the list, truncated, empty if unknown
+					float ms;
+				};
+				unsigned int render = 0; // number of the timed render, 0 if none was read back yet
+				float totalMs = 0.f;
+				ImVector<List> lists; // if gpuTimingPerList was set for that render
+				unsigned int skippedRenders = 0; // not timed as the GPU was too far behind, or disjoint
+			};
+			struct GPUTimer;
+			GPUTimer* gpuTimer = NULL; // owning pointer, created by Init
+			GPUTimings gpuTimings; // guarded by snapshotMutex
+
+			// Capture: if captureFrames is set, the draw data of the last captureFrames frames
+			// built by ImGui is kept in a ring buffer, so that a slow frame can be saved (see
+			// SaveCapture) and replayed. Frames are delta-encoded against the previous one (XOR
+			// of the buffers, zero runs skipped), with a keyframe every captureKeyframeInterval
+			// frames; frames older than the oldest keyframe in the ring can't be saved.
+			int captureFrames = 0;
+			int captureKeyframeInterval = 60;
+			struct CaptureRecorder;
+			CaptureRecorder* captureRecorder = NULL; // owning pointer, created by the first captured frame
         };
 
         IMGUI_SFML_API void Init(ImGuiSFMLContext& context, sf::RenderWindow& window, bool loadDefaultFont = true);
         IMGUI_SFML_API void Init(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& target, bool loadDefaultFont = true);
         IMGUI_SFML_API void Init(ImGuiSFMLContext& context, sf::Window& window, const sf::Vector2f& displaySize, bool loadDefaultFont = true);
+        // The context uses the fonts and font texture of sharedFonts, and holds a reference to
+        // them until Shutdown. alpha8FontAtlas and dynamic fonts aren't available then.
+        IMGUI_SFML_API void Init(ImGuiSFMLContext& context, sf::RenderWindow& window, SharedFontAtlas& sharedFonts);
+        IMGUI_SFML_API void Init(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& target, SharedFontAtlas& sharedFonts);
+
+        // Shared font atlas: returned with one reference, for the caller, who releases it once
+        // the contexts are initialized (or any time later). The last release, by the caller or by
+        // the Shutdown of a context, frees the atlas and the texture, in whatever order they come.
+        IMGUI_SFML_API SharedFontAtlas* CreateSharedFontAtlas(bool loadDefaultFont = true);
+        IMGUI_SFML_API void ReleaseSharedFontAtlas(SharedFontAtlas* sharedFonts);
+        // Builds the atlas if needed and uploads it, for every context using it
+        IMGUI_SFML_API void UpdateSharedFontTexture(SharedFontAtlas& sharedFonts);
+
+        // Returns true if the event affects ImGui (input while the window has focus, focus and size changes)
+        IMGUI_SFML_API bool ProcessEvent(ImGuiSFMLContext& context, const sf::Event& event);
+
+        // Input queue (see ImGuiSFMLContext::queueInput): records the event for the next Update.
+        // Can be called from an event-pump thread. Returns false if the queue is full.
+        IMGUI_SFML_API bool QueueEvent(ImGuiSFMLContext& context, const sf::Event& event);
 
-        IMGUI_SFML_API void ProcessEvent(ImGuiSFMLContext& context, const sf::Event& event);
+        // Idle mode: apps which only redraw on demand can skip Update/Render while this
+        // returns false. A frame is needed for a few frames after relevant events, while
+        // a mouse button is held and periodically while a text field shows its caret.
+        IMGUI_SFML_API bool IsFrameNeeded(ImGuiSFMLContext& context);
+        // Blocks until the window receives an event (returns true, event is filled) or
+        // until IsFrameNeeded returns true (returns false). Use it instead of pollEvent
+        // when there's nothing else to update.
+        IMGUI_SFML_API bool WaitEvent(ImGuiSFMLContext& context, sf::Window& window, sf::Event& event);
 
-        IMGUI_SFML_API void Update(ImGuiSFMLContext& context, sf::RenderWindow& window, sf::Time dt);
-        IMGUI_SFML_API void Update(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& target, sf::Time dt);
-        IMGUI_SFML_API void Update(ImGuiSFMLContext& context, const sf::Vector2i& mousePos, const sf::Vector2f& displaySize, sf::Time dt);
+        // Return true if ImGui::NewFrame was called, i.e. if the UI has to be built this frame (see SetUpdateRate)
+        IMGUI_SFML_API bool Update(ImGuiSFMLContext& context, sf::RenderWindow& window, sf::Time dt);
+        IMGUI_SFML_API bool Update(ImGuiSFMLContext& context, sf::Window& window, sf::RenderTarget& target, sf::Time dt);
+        IMGUI_SFML_API bool Update(ImGuiSFMLContext& context, const sf::Vector2i& mousePos, const sf::Vector2f& displaySize, sf::Time dt);
+
+        // Rebuilds ImGui at most `rate` times per second (0 means on every Update). Render
+        // draws a copy of the last built frame in between, input is kept for the next rebuild.
+        IMGUI_SFML_API void SetUpdateRate(ImGuiSFMLContext& context, float rate);
 
         IMGUI_SFML_API void Render(ImGuiSFMLContext& context, sf::RenderTarget& target);
         IMGUI_SFML_API void Render(ImGuiSFMLContext& context);
 
+        // Multi-threaded rendering: SubmitSnapshot ends the frame (instead of Render) and
+        // copies its draw data for RenderSnapshot, which can run on another thread with
+        // an active GL context. RenderSnapshot draws the latest submitted frame (or the
+        // previous one again) and must be the only function rendering this context.
+        // Textures used by ImGui must stay alive until they aren't drawn any more, and
+        // user callbacks run on the rendering thread.
+        IMGUI_SFML_API void SubmitSnapshot(ImGuiSFMLContext& context);
+        IMGUI_SFML_API void RenderSnapshot(ImGuiSFMLContext& context, sf::RenderTarget& target);
+
+        // Draws draw data built elsewhere (e.g. by a benchmark or a replay) without ending
+        // a frame. The draw data and the textures it uses must stay alive during the call.
+        IMGUI_SFML_API void RenderDrawData(ImGuiSFMLContext& context, sf::RenderTarget& target, ImDrawData* drawData);
+
+        // Capture (see ImGuiSFMLContext::captureFrames): writes the frames in the ring buffer,
+        // from the oldest keyframe on, with the size of the textures they draw. Call it from
+        // the thread which renders (or submits) the frames. Files are in the native byte
+        // order and only load in builds with the same ImDrawVert and ImDrawIdx.
+        IMGUI_SFML_API bool SaveCapture(ImGuiSFMLContext& context, const char* filename);
+        IMGUI_SFML_API DrawDataCapture* LoadCapture(const char* filename); // NULL on error
+        IMGUI_SFML_API void DestroyCapture(DrawDataCapture* capture);
+        IMGUI_SFML_API int GetCaptureFrameCount(const DrawDataCapture& capture);
+        IMGUI_SFML_API int GetCaptureTextureCount(const DrawDataCapture& capture);
+        IMGUI_SFML_API CaptureTexture& GetCaptureTexture(DrawDataCapture& capture, int index);
+        // Decodes a frame (from the previous keyframe, unless frames are read in order), to be
+        // drawn with RenderDrawData. Valid until the next call, NULL if the frame is corrupted.
+        IMGUI_SFML_API const ImGuiSFMLContext::DrawDataSnapshot* GetCaptureFrame(DrawDataCapture& capture, int index);
+
+        // Software rendering: rasterizes the frame on the CPU into an image of the display
+        // size (times the framebuffer scale), without any GL call. Call it instead of Render.
+        // The font atlas is sampled from ImGui's RGBA32 pixels, other textures must be
+        // registered with SetSoftwareTexture (NULL unregisters). User callbacks are skipped.
+        IMGUI_SFML_API void RenderToImage(ImGuiSFMLContext& context, sf::Image& image,
+            const sf::Color& clearColor = sf::Color::Transparent);
+        IMGUI_SFML_API void SetSoftwareTexture(ImGuiSFMLContext& context, const sf::Texture& texture, const sf::Image* image);
+
+        // Call when no thread calls RenderSnapshot any more
         IMGUI_SFML_API void Shutdown(ImGuiSFMLContext& context);
 
+        // Forces the next Render to redraw renderCache. Textures are only compared by ID,
+        // so call this after updating the pixels of a texture shown by ImGui.
+        IMGUI_SFML_API void InvalidateRenderCache(ImGuiSFMLContext& context);
+
+        // ImTextureID of a texture, registering it if needed. The Image and ImageButton overloads
+        // use it. The ID stays valid until the texture is unregistered, re-created (it gets a
+        // new GL name) or the context is shut down. Other ImTextureIDs are taken as GL names.
+        IMGUI_SFML_API ImTextureID GetTextureID(ImGuiSFMLContext& context, const sf::Texture& texture);
+        // Call before destroying a texture drawn by ImGui, so that its slot can be reused
+        IMGUI_SFML_API void UnregisterTexture(ImGuiSFMLContext& context, const sf::Texture& texture);
+
+        // Profiler (see ImGuiSFMLContext::enableProfiler): number of frames kept, and the
+        // profile of one of them, 0 being the last complete one
+        IMGUI_SFML_API int GetFrameProfileCount(ImGuiSFMLContext& context);
+        IMGUI_SFML_API ImGuiSFMLContext::FrameProfile GetFrameProfile(ImGuiSFMLContext& context, int age);
+        // Window with the frame-time graphs of each phase and the counters of the last frame
+        IMGUI_SFML_API void ShowProfilerWindow(ImGuiSFMLContext& context, bool* open = NULL);
+        // Latest GPU timings (see ImGuiSFMLContext::gpuTiming), false if none was read back yet
+        IMGUI_SFML_API bool GetGPUTimings(ImGuiSFMLContext& context, ImGuiSFMLContext::GPUTimings& timings);
+
         IMGUI_SFML_API void UpdateFontTexture(ImGuiSFMLContext& context);
         IMGUI_SFML_API sf::Texture& GetFontTexture(ImGuiSFMLContext& context);
 
+        // Adds a font whose glyphs (glyphRanges must stay alive, Latin if NULL) are only
+        // rasterized when they're first drawn. Only their metrics are read here, call
+        // UpdateFontTexture afterwards so that the atlas has room for the glyphs.
+        // The font is owned by the context, push it with ImGui::PushFont to use it.
+        IMGUI_SFML_API ImFont* AddDynamicFontFromFileTTF(ImGuiSFMLContext& context, const char* filename,
+            float sizePixels, const ImWchar* glyphRanges = NULL);
+
         // joystick functions
         IMGUI_SFML_API void SetActiveJoystickId(ImGuiSFMLContext& context, unsigned int joystickId);
         IMGUI_SFML_API void SetJoytickDPadThreshold(ImGuiSFMLContext& context, float threshold);
@@ -127,6 +518,12 @@ namespace ImGui
     IMGUI_SFML_API void DrawLine(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Color& col, float thickness = 1.0f);
     IMGUI_SFML_API void DrawRect(const sf::FloatRect& rect, const sf::Color& color, float rounding = 0.0f, int rounding_corners = 0x0F, float thickness = 1.0f);
     IMGUI_SFML_API void DrawRectFilled(const sf::FloatRect& rect, const sf::Color& color, float rounding = 0.0f, int rounding_corners = 0x0F);
+    // Draws SFML geometry with the colors of its vertices (texture coordinates are ignored), written
+    // straight into the window's draw list. Strips, fans and quads are triangulated, lines and
+    // points are drawn as 1 pixel wide quads.
+    IMGUI_SFML_API void DrawVertexArray(const sf::VertexArray& vertices, const sf::Transform& transform = sf::Transform::Identity);
+    IMGUI_SFML_API void DrawVertexArray(const sf::Vertex* vertices, std::size_t vertexCount, sf::PrimitiveType type,
+        const sf::Transform& transform = sf::Transform::Identity);
 }
 
 #endif //# IMGUI_SFML_H
@@ -0,0 +1,193 @@
+// Replays a capture written by ImGui::SFML::SaveCapture through the GL
+// renderer, and prints the timings of each frame as CSV.
+//
+// Usage: imgui-sfml-replay capture.bin [--frame N] [--repeat R] [--headless]
+//                          [--screenshot frame.png]
+// --frame replays one frame only (R times, 100 by default), so that it can be
+// profiled in isolation. --headless renders into an offscreen texture.
+// Textures are replaced by checkerboards of their size, the font texture by
+// the default font's, so text only looks right if the app used that font.
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/OpenGL.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void createCheckerboard(sf::Texture& texture, sf::Vector2u size) {
+    if (size.x == 0 || size.y == 0) size = sf::Vector2u(64, 64);
+    sf::Image image;
+    image.create(size.x, size.y);
+    for (unsigned int y = 0; y < size.y; ++y) {
+        for (unsigned int x = 0; x < size.x; ++x) {
+            bool light = ((x / 8) + (y / 8)) % 2 == 0;
+            image.setPixel(x, y, light ? sf::Color(200, 200, 200) : sf::Color(120, 120, 120));
+        }
+    }
+    texture.loadFromImage(image);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* capturePath = NULL;
+    const char* screenshotPath = NULL;
+    int onlyFrame = -1;
+    int repeat = 100;
+    bool headless = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frame") == 0 && i + 1 < argc) {
+            onlyFrame = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--screenshot") == 0 && i + 1 < argc) {
+            screenshotPath = argv[++i];
+        } else if (!capturePath && argv[i][0] != '-') {
+            capturePath = argv[i];
+        } else {
+            capturePath = NULL;
+            break;
+        }
+    }
+    if (!capturePath) {
+        std::fprintf(stderr,
+                     "usage: %s capture [--frame N] [--repeat R] [--headless] "
+                     "[--screenshot frame.png]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    ImGui::SFML::DrawDataCapture* capture = ImGui::SFML::LoadCapture(capturePath);
+    if (!capture) {
+        return 1;
+    }
+    int frameCount = ImGui::SFML::GetCaptureFrameCount(*capture);
+    if (onlyFrame >= frameCount) {
+        std::fprintf(stderr, "the capture has %d frames\n", frameCount);
+        ImGui::SFML::DestroyCapture(capture);
+        return 1;
+    }
+
+    // sized after the first frame, the render target doesn't follow later resizes
+    const ImGui::SFML::ImGuiSFMLContext::DrawDataSnapshot* first =
+        ImGui::SFML::GetCaptureFrame(*capture, 0);
+    if (!first) {
+        std::fprintf(stderr, "can't decode the first frame\n");
+        ImGui::SFML::DestroyCapture(capture);
+        return 1;
+    }
+    unsigned int width = (unsigned int)(first->data.DisplaySize.x * first->framebufferScale.x);
+    unsigned int height = (unsigned int)(first->data.DisplaySize.y * first->framebufferScale.y);
+    if (width == 0 || height == 0) width = 1280, height = 720;
+
+    sf::RenderWindow window(sf::VideoMode(headless ? 1 : width, headless ? 1 : height),
+                            "imgui-sfml-replay");
+    window.setVerticalSyncEnabled(false);
+    sf::RenderTexture offscreen;
+    if (headless) {
+        window.setVisible(false);
+        if (!offscreen.create(width, height)) {
+            std::fprintf(stderr, "can't create a %ux%u render texture\n", width, height);
+            ImGui::SFML::DestroyCapture(capture);
+            return 1;
+        }
+    }
+    sf::RenderTarget& target = headless ? static_cast<sf::RenderTarget&>(offscreen)
+                                        : static_cast<sf::RenderTarget&>(window);
+    window.setActive(true);
+
+    ImGui::SFML::ImGuiSFMLContext context;
+    context.gpuTiming = true;
+    ImGui::SFML::Init(context, window, target);
+
+    std::vector<std::unique_ptr<sf::Texture> > textures;
+    for (int i = 0; i < ImGui::SFML::GetCaptureTextureCount(*capture); ++i) {
+        ImGui::SFML::CaptureTexture& texture = ImGui::SFML::GetCaptureTexture(*capture, i);
+        if (texture.fontTexture) {
+            texture.replayID = ImGui::GetIO().Fonts->TexID;
+            continue;
+        }
+        textures.push_back(std::unique_ptr<sf::Texture>(new sf::Texture()));
+        createCheckerboard(*textures.back(), texture.size);
+        texture.replayID = (ImTextureID)(size_t)textures.back()->getNativeHandle();
+    }
+
+    std::printf("frame,lists,vertices,indices,draw_calls,submit_ms,finish_ms,gpu_ms\n");
+    int begin = onlyFrame >= 0 ? onlyFrame : 0;
+    int end = onlyFrame >= 0 ? onlyFrame + 1 : frameCount;
+    int rounds = onlyFrame >= 0 ? std::max(1, repeat) : 1;
+    for (int frame = begin; frame < end; ++frame) {
+        const ImGui::SFML::ImGuiSFMLContext::DrawDataSnapshot* snapshot =
+            ImGui::SFML::GetCaptureFrame(*capture, frame);
+        if (!snapshot) {
+            std::fprintf(stderr, "frame %d is corrupted, stopping\n", frame);
+            break;
+        }
+        ImGui::GetIO().DisplayFramebufferScale = snapshot->framebufferScale;
+        ImDrawData drawData = snapshot->data;
+
+        for (int round = 0; round < rounds; ++round) {
+            target.clear(sf::Color(45, 45, 48));
+            glFinish();
+            Clock::time_point start = Clock::now();
+            ImGui::SFML::RenderDrawData(context, target, &drawData);
+            double submitMs = elapsedMs(start);
+            glFinish();
+            double finishMs = elapsedMs(start);
+
+            // GPU time of an earlier render, as timer queries are read back later
+            ImGui::SFML::ImGuiSFMLContext::GPUTimings timings;
+            bool hasGpu = ImGui::SFML::GetGPUTimings(context, timings);
+            std::printf("%d,%d,%d,%d,%u,%.3f,%.3f,%.3f\n", frame, drawData.CmdListsCount,
+                        drawData.TotalVtxCount, drawData.TotalIdxCount,
+                        context.renderStats.drawCalls, submitMs, finishMs,
+                        hasGpu ? timings.totalMs : 0.f);
+
+            if (headless) {
+                offscreen.display();
+            } else {
+                window.display();
+            }
+        }
+    }
+
+    if (screenshotPath) {
+        sf::Image image;
+        if (headless) {
+            image = offscreen.getTexture().copyToImage();
+        } else {
+            sf::Texture copy;
+            copy.create(width, height);
+            copy.update(window);
+            image = copy.copyToImage();
+        }
+        if (!image.saveToFile(screenshotPath)) {
+            std::fprintf(stderr, "can't write %s\n", screenshotPath);
+        }
+    }
+
+    ImGui::SFML::Shutdown(context);
+    ImGui::SFML::DestroyCapture(capture);
+    return 0;
+}
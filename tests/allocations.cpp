@@ -0,0 +1,111 @@
+// Runs a steady-state ProcessEvent/Update/Render loop and checks that, once
+// ImGui's buffers have grown, frames don't allocate through the allocator.
+// Without a display (e.g. CI): xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ctest
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Window/Event.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const int WARM_UP_FRAMES = 120;
+const int FRAMES = 300;
+
+void* countingAlloc(size_t size, void* userData) {
+    ++*static_cast<unsigned long*>(userData);
+    return std::malloc(size);
+}
+
+void countingFree(void* ptr, void* /*userData*/) {
+    std::free(ptr);
+}
+
+void processEvents(ImGui::SFML::ImGuiSFMLContext& context, int frame) {
+    sf::Event event;
+    event.type = sf::Event::MouseMoved;
+    event.mouseMove.x = 20 + frame % 200;
+    event.mouseMove.y = 40 + frame % 100;
+    ImGui::SFML::ProcessEvent(context, event);
+
+    event.type = frame % 2 ? sf::Event::MouseButtonReleased : sf::Event::MouseButtonPressed;
+    event.mouseButton.button = sf::Mouse::Left;
+    event.mouseButton.x = 20 + frame % 200;
+    event.mouseButton.y = 40 + frame % 100;
+    ImGui::SFML::ProcessEvent(context, event);
+
+    event.type = sf::Event::MouseWheelScrolled;
+    event.mouseWheelScroll.wheel = sf::Mouse::VerticalWheel;
+    event.mouseWheelScroll.delta = frame % 2 ? 1.f : -1.f;
+    ImGui::SFML::ProcessEvent(context, event);
+
+    event.type = frame % 2 ? sf::Event::KeyReleased : sf::Event::KeyPressed;
+    event.key.code = sf::Keyboard::Down;
+    event.key.alt = event.key.control = event.key.shift = event.key.system = false;
+    ImGui::SFML::ProcessEvent(context, event);
+
+    event.type = sf::Event::TextEntered;
+    event.text.unicode = 'a' + frame % 26;
+    ImGui::SFML::ProcessEvent(context, event);
+}
+
+void buildFrame(int frame) {
+    static bool checked = false;
+    static float value = 0.5f;
+    ImGui::SetNextWindowPos(ImVec2(10.f, 10.f));
+    ImGui::SetNextWindowSize(ImVec2(300.f, 300.f));
+    ImGui::Begin("allocations");
+    ImGui::Text("frame %d", frame);
+    ImGui::Checkbox("checked", &checked);
+    ImGui::SliderFloat("value", &value, 0.f, 1.f);
+    for (int i = 0; i < 20; ++i) {
+        ImGui::PushID(i);
+        ImGui::Button("button");
+        ImGui::PopID();
+    }
+    ImGui::End();
+}
+
+}  // namespace
+
+int main() {
+    sf::RenderWindow window(sf::VideoMode(640, 480), "imgui-sfml-test-allocations");
+    window.setVisible(false);
+    window.setVerticalSyncEnabled(false);
+
+    unsigned long allocations = 0;
+    ImGui::SFML::ImGuiSFMLContext context;
+    context.allocator.allocFunc = countingAlloc;
+    context.allocator.freeFunc = countingFree;
+    context.allocator.userData = &allocations;
+    ImGui::SFML::Init(context, window);
+    ImGui::GetIO().IniFilename = NULL;
+
+    sf::Event focus;
+    focus.type = sf::Event::GainedFocus;
+    ImGui::SFML::ProcessEvent(context, focus);
+
+    int failures = 0;
+    for (int frame = 0; frame < WARM_UP_FRAMES + FRAMES; ++frame) {
+        unsigned long before = allocations;
+        processEvents(context, frame);
+        ImGui::SFML::Update(context, window, sf::milliseconds(16));
+        buildFrame(frame);
+        ImGui::SFML::Render(context, window);
+        window.display();
+
+        if (frame >= WARM_UP_FRAMES &&
+            (allocations != before || context.allocationStats.frameAllocations != 0)) {
+            std::fprintf(stderr, "allocations: frame %d made %lu allocations (%u counted)\n",
+                         frame, allocations - before, context.allocationStats.frameAllocations);
+            ++failures;
+        }
+    }
+
+    ImGui::SFML::Shutdown(context);
+    return failures == 0 ? 0 : 1;
+}
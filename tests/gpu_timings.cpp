@@ -0,0 +1,89 @@
+// Renders frames with gpuTiming and gpuTimingPerList set, and checks that
+// GetGPUTimings reads back a total time and one time per draw list. Needs
+// GL_ARB_timer_query (or GL_EXT_disjoint_timer_query), which llvmpipe has.
+// Without a display (e.g. CI): xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ctest
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const unsigned int WIDTH = 640;
+const unsigned int HEIGHT = 480;
+const int MAX_FRAMES = 200;
+const char* const WINDOWS[] = {"first", "second"};
+
+void buildFrame(int frame) {
+    for (int w = 0; w < 2; ++w) {
+        ImGui::SetNextWindowPos(ImVec2(10.f + w * 320.f, 10.f));
+        ImGui::SetNextWindowSize(ImVec2(300.f, 400.f));
+        ImGui::Begin(WINDOWS[w]);
+        for (int i = 0; i < 30; ++i) {
+            ImGui::Text("frame %d, line %d", frame, i);
+        }
+        ImGui::End();
+    }
+}
+
+bool hasOwner(const ImGui::SFML::ImGuiSFMLContext::GPUTimings& timings, const char* owner) {
+    for (int i = 0; i < timings.lists.Size; ++i) {
+        if (std::strcmp(timings.lists[i].owner, owner) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+int main() {
+    sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "imgui-sfml-test-gpu-timings");
+    window.setVisible(false);
+    sf::RenderTexture target;
+    if (!target.create(WIDTH, HEIGHT)) {
+        std::fprintf(stderr, "gpu_timings: can't create the render texture\n");
+        return 1;
+    }
+
+    ImGui::SFML::ImGuiSFMLContext context;
+    context.gpuTiming = true;
+    context.gpuTimingPerList = true;
+    ImGui::SFML::Init(context, window, target);
+    ImGui::GetIO().IniFilename = NULL;
+
+    // the queries are read back a few renders later, without waiting for the GPU
+    ImGui::SFML::ImGuiSFMLContext::GPUTimings timings;
+    int listCount = 0;
+    bool passed = false;
+    for (int frame = 0; !passed && frame < MAX_FRAMES; ++frame) {
+        ImGui::SFML::Update(context, sf::Vector2i(-1, -1), sf::Vector2f(WIDTH, HEIGHT),
+                            sf::milliseconds(16));
+        buildFrame(frame);
+        target.clear();
+        ImGui::SFML::Render(context, target);
+        target.display();
+        listCount = ImGui::GetDrawData()->CmdListsCount;
+
+        // the UI has the same lists every frame, so any timed render has them all
+        passed = ImGui::SFML::GetGPUTimings(context, timings) && timings.totalMs > 0.f &&
+                 timings.lists.Size == listCount && hasOwner(timings, WINDOWS[0]) &&
+                 hasOwner(timings, WINDOWS[1]);
+    }
+
+    if (!passed) {
+        std::fprintf(stderr,
+                     "gpu_timings: after %d frames, render %u took %f ms with %d timed lists of "
+                     "%d (%u renders skipped)\n",
+                     MAX_FRAMES, timings.render, timings.totalMs, timings.lists.Size, listCount,
+                     timings.skippedRenders);
+    }
+
+    ImGui::SFML::Shutdown(context);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+// Renders a window whose draw list holds a few million vertices through each
+// rendering path, and checks the pixels read back. With 16-bit indices ImGui
+// splits the list into commands with a VtxOffset, with 32-bit ones (the
+// large_draw_lists_32 build) the indices go past 65535.
+// Without a display (e.g. CI): xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ctest
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const unsigned int WIDTH = 640;
+const unsigned int HEIGHT = 480;
+const int CELL = 16;
+const int COLUMNS = WIDTH / CELL;
+const int ROWS = HEIGHT / CELL;
+// 650 layers of 1200 rects: 3.1 million vertices. Before 1.71, ImGui can't
+// split a list, so 16-bit builds stay below 65536 vertices.
+const int LAYERS = IMGUI_VERSION_NUM >= 17100 || sizeof(ImDrawIdx) == 4 ? 650 : 10;
+
+struct Path {
+    const char* name;
+    ImGui::SFML::RendererType renderer;
+    bool useVertexBuffers;
+};
+
+const Path PATHS[] = {
+    {"fixed-function", ImGui::SFML::Renderer_FixedFunction, false},
+    {"fixed-function with buffers", ImGui::SFML::Renderer_FixedFunction, true},
+    {"shader", ImGui::SFML::Renderer_Shader, false},
+};
+
+// opaque, and different for every cell of every layer
+ImU32 colorOf(int cell, int layer) {
+    unsigned int h = (unsigned int)(cell * 7919 + layer * 104729) * 2654435761u;
+    return IM_COL32(h >> 24, (h >> 16) & 0xFF, (h >> 8) & 0xFF, 255);
+}
+
+void buildFrame() {
+    ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+    ImGui::SetNextWindowSize(ImVec2((float)WIDTH, (float)HEIGHT));
+    ImGui::Begin("large draw list", NULL,
+                 ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+                     ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoBackground);
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->PushClipRect(ImVec2(0.f, 0.f), ImVec2((float)WIDTH, (float)HEIGHT), false);
+    // every layer covers the previous one, so vertices taken from the wrong
+    // place show an older layer's colors
+    for (int layer = 0; layer < LAYERS; ++layer) {
+        for (int cell = 0; cell < COLUMNS * ROWS; ++cell) {
+            ImVec2 min((float)(cell % COLUMNS * CELL), (float)(cell / COLUMNS * CELL));
+            drawList->AddRectFilled(min, ImVec2(min.x + CELL, min.y + CELL),
+                                    colorOf(cell, layer));
+        }
+    }
+    drawList->PopClipRect();
+    ImGui::End();
+}
+
+bool checkDrawData(const char* name) {
+    const ImDrawData* drawData = ImGui::GetDrawData();
+    if (!drawData || drawData->TotalVtxCount < LAYERS * COLUMNS * ROWS * 4) {
+        std::fprintf(stderr, "%s: %d vertices\n", name, drawData ? drawData->TotalVtxCount : 0);
+        return false;
+    }
+#if IMGUI_VERSION_NUM >= 17100
+    if (sizeof(ImDrawIdx) == 2) {
+        bool vtxOffset = false;
+        for (int n = 0; n < drawData->CmdListsCount; ++n) {
+            const ImDrawList* list = drawData->CmdLists[n];
+            for (int i = 0; i < list->CmdBuffer.Size; ++i) {
+                vtxOffset = vtxOffset || list->CmdBuffer[i].VtxOffset > 0;
+            }
+        }
+        if (!vtxOffset) {
+            std::fprintf(stderr, "%s: no command has a VtxOffset\n", name);
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+bool checkPixels(const char* name, const sf::Image& image) {
+    int wrong = 0;
+    for (int cell = 0; cell < COLUMNS * ROWS; ++cell) {
+        unsigned int x = cell % COLUMNS * CELL + CELL / 2;
+        unsigned int y = cell / COLUMNS * CELL + CELL / 2;
+        ImU32 expected = colorOf(cell, LAYERS - 1);
+        sf::Color pixel = image.getPixel(x, y);
+        int r = (int)(expected >> IM_COL32_R_SHIFT) & 0xFF;
+        int g = (int)(expected >> IM_COL32_G_SHIFT) & 0xFF;
+        int b = (int)(expected >> IM_COL32_B_SHIFT) & 0xFF;
+        if (std::abs(pixel.r - r) > 1 || std::abs(pixel.g - g) > 1 || std::abs(pixel.b - b) > 1) {
+            if (wrong++ == 0) {
+                std::fprintf(stderr, "%s: pixel (%u, %u) is %d %d %d instead of %d %d %d\n", name,
+                             x, y, pixel.r, pixel.g, pixel.b, r, g, b);
+            }
+        }
+    }
+    if (wrong > 0) {
+        std::fprintf(stderr, "%s: %d cells of %d are wrong\n", name, wrong, COLUMNS * ROWS);
+    }
+    return wrong == 0;
+}
+
+bool renderPath(sf::RenderWindow& window, const Path& path) {
+    sf::RenderTexture target;
+    if (!target.create(WIDTH, HEIGHT)) {
+        std::fprintf(stderr, "%s: can't create the render texture\n", path.name);
+        return false;
+    }
+
+    ImGui::SFML::ImGuiSFMLContext context;
+    context.renderer = path.renderer;
+    context.useVertexBuffers = path.useVertexBuffers;
+    ImGui::SFML::Init(context, window, target);
+    ImGui::GetIO().IniFilename = NULL;
+
+    bool passed = true;
+    if (context.renderer != path.renderer) {
+        std::fprintf(stderr, "%s: Init fell back to another renderer\n", path.name);
+        passed = false;
+    }
+
+    // ImGui can hide a new window on its first frame
+    for (int frame = 0; passed && frame < 2; ++frame) {
+        ImGui::SFML::Update(context, sf::Vector2i(-1, -1), sf::Vector2f(WIDTH, HEIGHT),
+                            sf::milliseconds(16));
+        buildFrame();
+        target.clear(sf::Color::Black);
+        ImGui::SFML::Render(context, target);
+        target.display();
+    }
+
+    if (passed && path.useVertexBuffers && context.vertexBuffer == 0) {
+        std::fprintf(stderr, "%s: the vertex buffers weren't used\n", path.name);
+        passed = false;
+    }
+    passed = passed && checkDrawData(path.name) &&
+             checkPixels(path.name, target.getTexture().copyToImage());
+
+    ImGui::SFML::Shutdown(context);
+    return passed;
+}
+
+}  // namespace
+
+int main() {
+    sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "imgui-sfml-test-large-draw-lists");
+    window.setVisible(false);
+
+    bool passed = true;
+    for (unsigned int i = 0; i < sizeof(PATHS) / sizeof(PATHS[0]); ++i) {
+        bool pathPassed = renderPath(window, PATHS[i]);
+        std::printf("%s, %d-bit indices: %s\n", PATHS[i].name, (int)sizeof(ImDrawIdx) * 8,
+                    pathPassed ? "passed" : "failed");
+        passed = passed && pathPassed;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// Builds and renders frames for several contexts at once, one per thread, with
+// IMGUI_SFML_THREAD_LOCAL_CONTEXT. Meant to be run with IMGUI_SFML_SANITIZE_THREAD=ON,
+// which reports state the contexts share without a lock.
+// Without a display (e.g. CI): xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ctest
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#ifndef IMGUI_SFML_THREAD_LOCAL_CONTEXT
+#error "parallel_contexts needs IMGUI_SFML_THREAD_LOCAL_CONTEXT"
+#endif
+
+namespace {
+
+const int CONTEXTS = 4;
+const int FRAMES = 200;
+
+struct Worker {
+    ImGui::SFML::ImGuiSFMLContext context;
+    sf::RenderWindow* window = NULL;
+    int frames = 0;            // frames which drew something
+    bool otherContext = false; // ImGui's current context was another context's
+};
+
+void run(Worker* worker, int index) {
+    ImGui::SFML::ImGuiSFMLContext& context = worker->context;
+    worker->window->setActive(true);
+    bool checked = false;
+    float value = 0.f;
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        ImGui::SFML::Update(context, sf::Vector2i(frame % 320, frame % 240),
+                            sf::Vector2f(320.f, 240.f), sf::milliseconds(16));
+        ImGui::Begin("parallel contexts");
+        ImGui::Text("context %d, frame %d", index, frame);
+        ImGui::Checkbox("checked", &checked);
+        ImGui::SliderFloat("value", &value, 0.f, 1.f);
+        for (int i = 0; i < (frame + index) % 20; ++i) {
+            ImGui::PushID(i);
+            ImGui::Button("button");
+            ImGui::PopID();
+        }
+        ImGui::End();
+        if (ImGui::GetCurrentContext() != context.imguiContext) {
+            worker->otherContext = true;
+        }
+
+        worker->window->clear();
+        ImGui::SFML::Render(context, *worker->window);
+        worker->window->display();
+        if (context.renderStats.drawCalls > 0) {
+            ++worker->frames;
+        }
+    }
+    worker->window->setActive(false);
+}
+
+}  // namespace
+
+int main() {
+    // windows and contexts are created on the main thread, and used by the workers
+    std::vector<sf::RenderWindow*> windows;
+    Worker workers[CONTEXTS];
+    for (int i = 0; i < CONTEXTS; ++i) {
+        windows.push_back(new sf::RenderWindow(sf::VideoMode(320, 240), "imgui-sfml-test-parallel-contexts"));
+        windows[i]->setVisible(false);
+        windows[i]->setVerticalSyncEnabled(false);
+        workers[i].window = windows[i];
+        ImGui::SFML::Init(workers[i].context, *windows[i]);
+        ImGui::GetIO().IniFilename = NULL;
+        windows[i]->setActive(false);
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < CONTEXTS; ++i) {
+        threads.push_back(std::thread(run, &workers[i], i));
+    }
+    for (int i = 0; i < CONTEXTS; ++i) {
+        threads[i].join();
+    }
+
+    bool passed = true;
+    for (int i = 0; i < CONTEXTS; ++i) {
+        if (workers[i].frames != FRAMES || workers[i].otherContext) {
+            std::fprintf(stderr, "parallel_contexts: context %d drew %d frames of %d%s\n", i,
+                         workers[i].frames, FRAMES,
+                         workers[i].otherContext ? ", and ran with another context" : "");
+            passed = false;
+        }
+        windows[i]->setActive(true);
+        ImGui::SFML::Shutdown(workers[i].context);
+        delete windows[i];
+    }
+    return passed ? 0 : 1;
+}
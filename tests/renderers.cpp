@@ -0,0 +1,126 @@
+// Renders the same frame with a Renderer_FixedFunction context and a
+// Renderer_Shader one, and compares the pixels read back. Fails if Init fell
+// back to the fixed-function path, so the shader path is really compared.
+// Without a display (e.g. CI): xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ctest
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const unsigned int WIDTH = 640;
+const unsigned int HEIGHT = 480;
+const int FRAMES = 3;
+const int TOLERANCE = 2;          // per channel
+const float MAX_DIFFERENT = 0.001f; // fraction of the pixels
+
+void buildFrame() {
+    static bool checked = true;
+    static float value = 0.25f;
+    static float color[3] = {0.8f, 0.3f, 0.1f};
+    ImGui::SetNextWindowPos(ImVec2(20.f, 20.f));
+    ImGui::SetNextWindowSize(ImVec2(400.f, 300.f));
+    ImGui::Begin("renderers");
+    ImGui::Text("The same frame through both renderers");
+    ImGui::Checkbox("checked", &checked);
+    ImGui::SliderFloat("value", &value, 0.f, 1.f);
+    ImGui::ColorEdit3("color", color);
+    ImGui::Button("button", ImVec2(120.f, 40.f));
+    ImGui::ProgressBar(0.6f);
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    drawList->AddCircleFilled(ImVec2(pos.x + 40.f, pos.y + 40.f), 30.f, IM_COL32(40, 200, 90, 160));
+    drawList->AddRectFilled(ImVec2(pos.x + 90.f, pos.y + 10.f), ImVec2(pos.x + 200.f, pos.y + 70.f),
+                            IM_COL32(200, 40, 160, 255), 8.f);
+    ImGui::End();
+}
+
+bool renderFrames(ImGui::SFML::ImGuiSFMLContext& context, sf::RenderTexture& target) {
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        ImGui::SFML::Update(context, sf::Vector2i(-1, -1), sf::Vector2f(WIDTH, HEIGHT),
+                            sf::milliseconds(16));
+        buildFrame();
+        target.clear(sf::Color(30, 30, 30));
+        ImGui::SFML::Render(context, target);
+        target.display();
+    }
+    return context.renderStats.drawCalls > 0;
+}
+
+}  // namespace
+
+int main() {
+    sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "imgui-sfml-test-renderers");
+    window.setVisible(false);
+
+    sf::RenderTexture fixedTarget, shaderTarget;
+    if (!fixedTarget.create(WIDTH, HEIGHT) || !shaderTarget.create(WIDTH, HEIGHT)) {
+        std::fprintf(stderr, "renderers: can't create the render textures\n");
+        return 1;
+    }
+
+    ImGui::SFML::ImGuiSFMLContext fixedContext;
+    fixedContext.renderer = ImGui::SFML::Renderer_FixedFunction;
+    ImGui::SFML::Init(fixedContext, window, fixedTarget);
+    ImGui::GetIO().IniFilename = NULL;
+
+    ImGui::SFML::ImGuiSFMLContext shaderContext;
+    shaderContext.renderer = ImGui::SFML::Renderer_Shader;
+    ImGui::SFML::Init(shaderContext, window, shaderTarget);
+    ImGui::GetIO().IniFilename = NULL;
+
+    bool passed = true;
+    if (shaderContext.renderer != ImGui::SFML::Renderer_Shader) {
+        std::fprintf(stderr, "renderers: Init fell back to the fixed-function renderer\n");
+        passed = false;
+    }
+
+    if (passed && (!renderFrames(fixedContext, fixedTarget) ||
+                   !renderFrames(shaderContext, shaderTarget))) {
+        std::fprintf(stderr, "renderers: nothing was drawn\n");
+        passed = false;
+    }
+
+    if (passed) {
+        sf::Image fixedImage = fixedTarget.getTexture().copyToImage();
+        sf::Image shaderImage = shaderTarget.getTexture().copyToImage();
+        sf::Color background(30, 30, 30);
+        unsigned int different = 0, drawn = 0;
+        for (unsigned int y = 0; y < HEIGHT; ++y) {
+            for (unsigned int x = 0; x < WIDTH; ++x) {
+                sf::Color a = fixedImage.getPixel(x, y);
+                sf::Color b = shaderImage.getPixel(x, y);
+                if (std::abs(a.r - b.r) > TOLERANCE || std::abs(a.g - b.g) > TOLERANCE ||
+                    std::abs(a.b - b.b) > TOLERANCE) {
+                    if (different++ == 0) {
+                        std::fprintf(stderr, "renderers: pixel (%u, %u) is %d %d %d and %d %d %d\n",
+                                     x, y, a.r, a.g, a.b, b.r, b.g, b.b);
+                    }
+                }
+                if (a != background) {
+                    ++drawn;
+                }
+            }
+        }
+        if (different > MAX_DIFFERENT * WIDTH * HEIGHT) {
+            std::fprintf(stderr, "renderers: %u pixels differ\n", different);
+            passed = false;
+        }
+        // the window covers a good part of the target
+        if (drawn < WIDTH * HEIGHT / 10) {
+            std::fprintf(stderr, "renderers: only %u pixels were drawn\n", drawn);
+            passed = false;
+        }
+    }
+
+    ImGui::SFML::Shutdown(shaderContext);
+    ImGui::SFML::Shutdown(fixedContext);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+// Builds frames on the main thread and renders them with RenderSnapshot on
+// another thread, so that the double-buffered snapshots are handed over while
+// both threads run. Meant to be run with IMGUI_SFML_SANITIZE_THREAD=ON. GPU
+// timing is on, so the timer queries are read back on the render thread too.
+// Without a display (e.g. CI): xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ctest
+
+#include "imgui.h"
+#include "imgui-SFML.h"
+
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Window/Event.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+const int FRAMES = 500;
+
+void renderLoop(ImGui::SFML::ImGuiSFMLContext* context, sf::RenderWindow* window,
+                std::atomic<bool>* done, int* renders) {
+    window->setActive(true);
+    // one more render once the last frame is submitted
+    for (bool last = false; !last;) {
+        last = done->load();
+        ImGui::SFML::RenderSnapshot(*context, *window);
+        window->display();
+        ++*renders;
+    }
+    window->setActive(false);
+}
+
+}  // namespace
+
+int main() {
+    sf::RenderWindow window(sf::VideoMode(640, 480), "imgui-sfml-test-snapshots");
+    window.setVisible(false);
+    window.setVerticalSyncEnabled(false);
+
+    ImGui::SFML::ImGuiSFMLContext context;
+    context.gpuTiming = true;
+    context.gpuTimingPerList = true;
+    ImGui::SFML::Init(context, window);
+    ImGui::GetIO().IniFilename = NULL;
+    window.setActive(false);
+
+    sf::Event focus;
+    focus.type = sf::Event::GainedFocus;
+    ImGui::SFML::ProcessEvent(context, focus);
+
+    std::atomic<bool> done(false);
+    int renders = 0;
+    std::thread renderThread(renderLoop, &context, &window, &done, &renders);
+
+    bool checked = false;
+    float value = 0.f;
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        sf::Event event;
+        event.type = sf::Event::MouseMoved;
+        event.mouseMove.x = frame % 640;
+        event.mouseMove.y = (frame * 7) % 480;
+        ImGui::SFML::ProcessEvent(context, event);
+
+        ImGui::SFML::Update(context, sf::Vector2i(event.mouseMove.x, event.mouseMove.y),
+                            sf::Vector2f(640.f, 480.f), sf::milliseconds(16));
+        ImGui::Begin("snapshots");
+        ImGui::Text("frame %d", frame);
+        ImGui::Checkbox("checked", &checked);
+        ImGui::SliderFloat("value", &value, 0.f, 1.f);
+        for (int i = 0; i < frame % 50; ++i) {
+            ImGui::Button("button");  // the size of the draw data changes every frame
+        }
+        ImGui::End();
+        ImGui::SFML::SubmitSnapshot(context);
+
+        // written by the render thread
+        ImGui::SFML::ImGuiSFMLContext::GPUTimings timings;
+        ImGui::SFML::GetGPUTimings(context, timings);
+    }
+
+    done.store(true);
+    renderThread.join();
+    window.setActive(true);
+
+    bool passed = renders > 0 && context.snapshotReady == -1 && context.snapshotRendered != -1;
+    if (!passed) {
+        std::fprintf(stderr, "snapshots: %d renders, ready %d, rendered %d\n", renders,
+                     context.snapshotReady, context.snapshotRendered);
+    }
+
+    ImGui::SFML::Shutdown(context);
+    return passed ? 0 : 1;
+}